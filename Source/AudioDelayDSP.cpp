@@ -0,0 +1,302 @@
+#include "AudioDelayDSP.h"
+#include "DelayEngine.h"
+#include <new>
+
+struct AudioDelayEngine
+{
+    DelayEngine<float> engine;
+    DelayParameters parameters;
+    juce::AudioBuffer<float> scratch; // planar copy of interleaved input, and the view for planar calls
+    int numChannels = 0;
+    int maxBlockSize = 0;
+    bool prepared = false;
+};
+
+namespace
+{
+    bool isInRange(float value, float minimum, float maximum)
+    {
+        return value >= minimum && value <= maximum; // also rejects NaN
+    }
+
+    // Runs one stretch of at most maxBlockSize frames already laid out in the scratch channels
+    void processScratch(AudioDelayEngine &state, int numFrames)
+    {
+        juce::AudioBuffer<float> block(state.scratch.getArrayOfWritePointers(), state.numChannels, numFrames);
+        state.engine.process(block, state.numChannels, state.parameters);
+    }
+}
+
+int32_t audiodelay_get_api_version(void)
+{
+    return AUDIODELAY_API_VERSION;
+}
+
+AudioDelayEngine *audiodelay_create(void)
+{
+    return new (std::nothrow) AudioDelayEngine();
+}
+
+void audiodelay_destroy(AudioDelayEngine *engine)
+{
+    delete engine;
+}
+
+AudioDelayStatus audiodelay_prepare(AudioDelayEngine *engine, double sample_rate, int32_t max_block_size, int32_t num_channels)
+{
+    if (engine == nullptr || !(sample_rate > 0.0) || max_block_size <= 0 || num_channels < 1 || num_channels > 2)
+        return AUDIODELAY_ERROR_INVALID_ARGUMENT;
+
+    // Nothing may throw across the C boundary
+    try
+    {
+        juce::dsp::ProcessSpec spec;
+        spec.sampleRate = sample_rate;
+        spec.maximumBlockSize = static_cast<juce::uint32>(max_block_size);
+        spec.numChannels = static_cast<juce::uint32>(num_channels);
+
+        engine->engine.prepare(spec, engine->parameters);
+        engine->scratch.setSize(num_channels, max_block_size);
+        engine->numChannels = num_channels;
+        engine->maxBlockSize = max_block_size;
+        engine->prepared = true;
+    }
+    catch (const std::bad_alloc &)
+    {
+        engine->prepared = false;
+        return AUDIODELAY_ERROR_OUT_OF_MEMORY;
+    }
+
+    return AUDIODELAY_OK;
+}
+
+AudioDelayStatus audiodelay_set_parameter(AudioDelayEngine *engine, AudioDelayParameter parameter, float value)
+{
+    if (engine == nullptr)
+        return AUDIODELAY_ERROR_INVALID_ARGUMENT;
+
+    auto &p = engine->parameters;
+
+    auto setFloat = [value](float &field, float minimum, float maximum)
+    {
+        if (!isInRange(value, minimum, maximum))
+            return AUDIODELAY_ERROR_INVALID_ARGUMENT;
+        field = value;
+        return AUDIODELAY_OK;
+    };
+    auto setSwitch = [value](bool &field)
+    {
+        if (value != 0.0f && value != 1.0f)
+            return AUDIODELAY_ERROR_INVALID_ARGUMENT;
+        field = value != 0.0f;
+        return AUDIODELAY_OK;
+    };
+
+    switch (parameter)
+    {
+    case AUDIODELAY_PARAM_DELAY_MS:
+        return setFloat(p.delay, 0.0f, 5000.0f);
+    case AUDIODELAY_PARAM_FEEDBACK:
+        return setFloat(p.feedback, 0.0f, 0.95f);
+    case AUDIODELAY_PARAM_MIX:
+        return setFloat(p.mix, 0.0f, 1.0f);
+    case AUDIODELAY_PARAM_BITCRUSH:
+        return setFloat(p.bitcrush, 1.0f, 16.0f);
+    case AUDIODELAY_PARAM_STEREO_WIDTH:
+        return setFloat(p.stereoWidth, 0.0f, 2.0f);
+    case AUDIODELAY_PARAM_PAN:
+        return setFloat(p.pan, -1.0f, 1.0f);
+    case AUDIODELAY_PARAM_HIGHPASS_HZ:
+        return setFloat(p.highpassFreq, 20.0f, 5000.0f);
+    case AUDIODELAY_PARAM_LOWPASS_HZ:
+        return setFloat(p.lowpassFreq, 200.0f, 20000.0f);
+    case AUDIODELAY_PARAM_LFO_HZ:
+        return setFloat(p.lfoFreq, 0.01f, 20.0f);
+    case AUDIODELAY_PARAM_LFO_AMOUNT:
+        return setFloat(p.lfoAmount, 0.0f, 1.0f);
+    case AUDIODELAY_PARAM_SMEAR:
+        return setFloat(p.smear, 0.0f, 1.0f);
+    case AUDIODELAY_PARAM_WAVESHAPE:
+        return setFloat(p.waveshapeAmount, 0.0f, 1.0f);
+    case AUDIODELAY_PARAM_LFO_BITCRUSH:
+        return setSwitch(p.lfoBitcrush);
+    case AUDIODELAY_PARAM_LFO_HIGHPASS:
+        return setSwitch(p.lfoHighpass);
+    case AUDIODELAY_PARAM_LFO_LOWPASS:
+        return setSwitch(p.lfoLowpass);
+    case AUDIODELAY_PARAM_LFO_PAN:
+        return setSwitch(p.lfoPan);
+    case AUDIODELAY_PARAM_LFO_DELAY:
+        return setSwitch(p.lfoDelay);
+    case AUDIODELAY_PARAM_DELAY_JUMP:
+        return setSwitch(p.delayJump);
+    case AUDIODELAY_PARAM_NETWORK_LINES:
+        if (value != 0.0f && value != 4.0f && value != 8.0f && value != 16.0f)
+            return AUDIODELAY_ERROR_INVALID_ARGUMENT;
+        p.fdnLines = static_cast<int>(value);
+        return AUDIODELAY_OK;
+    case AUDIODELAY_PARAM_FREEZE:
+        return setSwitch(p.freeze);
+    case AUDIODELAY_PARAM_SHIMMER:
+        return setFloat(p.shimmer, 0.0f, 1.0f);
+    case AUDIODELAY_PARAM_SHIMMER_PITCH:
+        return setFloat(p.shimmerPitch, -12.0f, 12.0f);
+    case AUDIODELAY_PARAM_REVERSE:
+        return setSwitch(p.reverse);
+    case AUDIODELAY_PARAM_LFO2_HZ:
+        return setFloat(p.lfo2Freq, 0.01f, 20.0f);
+    case AUDIODELAY_PARAM_FILTER_SLOPE:
+        if (value != 12.0f && value != 24.0f && value != 36.0f && value != 48.0f)
+            return AUDIODELAY_ERROR_INVALID_ARGUMENT;
+        p.filterSlope = static_cast<int>(value);
+        return AUDIODELAY_OK;
+    case AUDIODELAY_PARAM_SPECTRAL:
+        return setSwitch(p.spectral);
+    case AUDIODELAY_PARAM_SPECTRAL_HOP:
+        if (value != 128.0f && value != 256.0f && value != 512.0f && value != 1024.0f)
+            return AUDIODELAY_ERROR_INVALID_ARGUMENT;
+        p.spectralHop = static_cast<int>(value);
+        return AUDIODELAY_OK;
+    case AUDIODELAY_PARAM_SPECTRAL_TILT:
+        return setFloat(p.spectralTilt, -1.0f, 1.0f);
+    }
+
+    return AUDIODELAY_ERROR_UNKNOWN_PARAMETER;
+}
+
+AudioDelayStatus audiodelay_get_parameter(const AudioDelayEngine *engine, AudioDelayParameter parameter, float *value)
+{
+    if (engine == nullptr || value == nullptr)
+        return AUDIODELAY_ERROR_INVALID_ARGUMENT;
+
+    const auto &p = engine->parameters;
+
+    switch (parameter)
+    {
+    case AUDIODELAY_PARAM_DELAY_MS: *value = p.delay; break;
+    case AUDIODELAY_PARAM_FEEDBACK: *value = p.feedback; break;
+    case AUDIODELAY_PARAM_MIX: *value = p.mix; break;
+    case AUDIODELAY_PARAM_BITCRUSH: *value = p.bitcrush; break;
+    case AUDIODELAY_PARAM_STEREO_WIDTH: *value = p.stereoWidth; break;
+    case AUDIODELAY_PARAM_PAN: *value = p.pan; break;
+    case AUDIODELAY_PARAM_HIGHPASS_HZ: *value = p.highpassFreq; break;
+    case AUDIODELAY_PARAM_LOWPASS_HZ: *value = p.lowpassFreq; break;
+    case AUDIODELAY_PARAM_LFO_HZ: *value = p.lfoFreq; break;
+    case AUDIODELAY_PARAM_LFO_AMOUNT: *value = p.lfoAmount; break;
+    case AUDIODELAY_PARAM_SMEAR: *value = p.smear; break;
+    case AUDIODELAY_PARAM_WAVESHAPE: *value = p.waveshapeAmount; break;
+    case AUDIODELAY_PARAM_LFO_BITCRUSH: *value = p.lfoBitcrush ? 1.0f : 0.0f; break;
+    case AUDIODELAY_PARAM_LFO_HIGHPASS: *value = p.lfoHighpass ? 1.0f : 0.0f; break;
+    case AUDIODELAY_PARAM_LFO_LOWPASS: *value = p.lfoLowpass ? 1.0f : 0.0f; break;
+    case AUDIODELAY_PARAM_LFO_PAN: *value = p.lfoPan ? 1.0f : 0.0f; break;
+    case AUDIODELAY_PARAM_LFO_DELAY: *value = p.lfoDelay ? 1.0f : 0.0f; break;
+    case AUDIODELAY_PARAM_DELAY_JUMP: *value = p.delayJump ? 1.0f : 0.0f; break;
+    case AUDIODELAY_PARAM_NETWORK_LINES: *value = static_cast<float>(p.fdnLines); break;
+    case AUDIODELAY_PARAM_FREEZE: *value = p.freeze ? 1.0f : 0.0f; break;
+    case AUDIODELAY_PARAM_SHIMMER: *value = p.shimmer; break;
+    case AUDIODELAY_PARAM_SHIMMER_PITCH: *value = p.shimmerPitch; break;
+    case AUDIODELAY_PARAM_REVERSE: *value = p.reverse ? 1.0f : 0.0f; break;
+    case AUDIODELAY_PARAM_LFO2_HZ: *value = p.lfo2Freq; break;
+    case AUDIODELAY_PARAM_FILTER_SLOPE: *value = static_cast<float>(p.filterSlope); break;
+    case AUDIODELAY_PARAM_SPECTRAL: *value = p.spectral ? 1.0f : 0.0f; break;
+    case AUDIODELAY_PARAM_SPECTRAL_HOP: *value = static_cast<float>(p.spectralHop); break;
+    case AUDIODELAY_PARAM_SPECTRAL_TILT: *value = p.spectralTilt; break;
+    default: return AUDIODELAY_ERROR_UNKNOWN_PARAMETER;
+    }
+
+    return AUDIODELAY_OK;
+}
+
+AudioDelayStatus audiodelay_set_mod_route(AudioDelayEngine *engine, int32_t slot, AudioDelayModSource source,
+                                          AudioDelayModDestination destination, float depth)
+{
+    static_assert(AUDIODELAY_MAX_MOD_ROUTES == ModulationRoute::MAX_ROUTES, "C interface out of step with the matrix");
+    static_assert(AUDIODELAY_MOD_SOURCE_ENVELOPE == static_cast<int>(ModulationRoute::Envelope), "C interface out of step with the matrix");
+    static_assert(AUDIODELAY_MOD_DEST_SHIMMER == static_cast<int>(ModulationRoute::Shimmer), "C interface out of step with the matrix");
+
+    const int sourceIndex = static_cast<int>(source);
+    const int destinationIndex = static_cast<int>(destination);
+
+    if (engine == nullptr || slot < 0 || slot >= ModulationRoute::MAX_ROUTES
+        || sourceIndex < 0 || sourceIndex >= ModulationRoute::NumSources
+        || destinationIndex < 0 || destinationIndex >= ModulationRoute::NumDestinations
+        || !isInRange(depth, -1.0f, 1.0f))
+        return AUDIODELAY_ERROR_INVALID_ARGUMENT;
+
+    auto &route = engine->parameters.modRoutes[static_cast<size_t>(slot)];
+    route.source = sourceIndex;
+    route.destination = destinationIndex;
+    route.depth = depth;
+    return AUDIODELAY_OK;
+}
+
+AudioDelayStatus audiodelay_get_latency(const AudioDelayEngine *engine, int32_t *latency_samples)
+{
+    if (engine == nullptr || latency_samples == nullptr)
+        return AUDIODELAY_ERROR_INVALID_ARGUMENT;
+
+    // From the parameters rather than the engine, which only catches up on its next block
+    const auto &p = engine->parameters;
+    *latency_samples = p.spectral ? SpectralDelay<float>::OVERLAP * p.spectralHop : 0;
+    return AUDIODELAY_OK;
+}
+
+AudioDelayStatus audiodelay_process_planar(AudioDelayEngine *engine, float *const *channels, int32_t num_channels, int32_t num_frames)
+{
+    if (engine == nullptr || channels == nullptr || num_frames < 0)
+        return AUDIODELAY_ERROR_INVALID_ARGUMENT;
+    if (!engine->prepared)
+        return AUDIODELAY_ERROR_NOT_PREPARED;
+    if (num_channels != engine->numChannels)
+        return AUDIODELAY_ERROR_INVALID_ARGUMENT;
+
+    for (int channel = 0; channel < num_channels; ++channel)
+        if (channels[channel] == nullptr)
+            return AUDIODELAY_ERROR_INVALID_ARGUMENT;
+
+    // The caller's channels are processed where they are, a block at a time
+    for (int start = 0; start < num_frames; start += engine->maxBlockSize)
+    {
+        int numFrames = juce::jmin(engine->maxBlockSize, num_frames - start);
+        float *offsetChannels[2] = {channels[0] + start, num_channels > 1 ? channels[1] + start : nullptr};
+
+        juce::AudioBuffer<float> block(offsetChannels, num_channels, numFrames);
+        engine->engine.process(block, num_channels, engine->parameters);
+    }
+
+    return AUDIODELAY_OK;
+}
+
+AudioDelayStatus audiodelay_process_interleaved(AudioDelayEngine *engine, float *samples, int32_t num_channels, int32_t num_frames)
+{
+    if (engine == nullptr || samples == nullptr || num_frames < 0)
+        return AUDIODELAY_ERROR_INVALID_ARGUMENT;
+    if (!engine->prepared)
+        return AUDIODELAY_ERROR_NOT_PREPARED;
+    if (num_channels != engine->numChannels)
+        return AUDIODELAY_ERROR_INVALID_ARGUMENT;
+
+    for (int start = 0; start < num_frames; start += engine->maxBlockSize)
+    {
+        int numFrames = juce::jmin(engine->maxBlockSize, num_frames - start);
+        float *frames = samples + static_cast<size_t>(start) * static_cast<size_t>(num_channels);
+
+        for (int channel = 0; channel < num_channels; ++channel)
+        {
+            auto *planar = engine->scratch.getWritePointer(channel);
+            for (int frame = 0; frame < numFrames; ++frame)
+                planar[frame] = frames[frame * num_channels + channel];
+        }
+
+        processScratch(*engine, numFrames);
+
+        for (int channel = 0; channel < num_channels; ++channel)
+        {
+            const auto *planar = engine->scratch.getReadPointer(channel);
+            for (int frame = 0; frame < numFrames; ++frame)
+                frames[frame * num_channels + channel] = planar[frame];
+        }
+    }
+
+    return AUDIODELAY_OK;
+}
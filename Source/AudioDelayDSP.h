@@ -0,0 +1,133 @@
+#ifndef AUDIODELAY_DSP_H
+#define AUDIODELAY_DSP_H
+
+/*
+ * C interface to the delay engine, for hosts that want the DSP without the plugin wrapper.
+ *
+ * An engine is created, prepared for a sample rate, block size and channel count (1 or 2), given
+ * parameters and then fed audio in place, planar or interleaved. Parameter changes take effect on
+ * the next process call and glide the way host automation does. Nothing here is thread-safe: set
+ * parameters and process from the same thread, or serialise the calls.
+ *
+ * ABI rules: functions and enum values are only ever added, never changed or reordered, and the
+ * engine stays opaque. audiodelay_get_api_version() reports the additions a caller can rely on.
+ */
+
+#include <stdint.h>
+
+#if defined(_WIN32) && defined(AUDIODELAY_DSP_SHARED)
+#if defined(AUDIODELAY_DSP_BUILDING)
+#define AUDIODELAY_API __declspec(dllexport)
+#else
+#define AUDIODELAY_API __declspec(dllimport)
+#endif
+#elif defined(__GNUC__)
+#define AUDIODELAY_API __attribute__((visibility("default")))
+#else
+#define AUDIODELAY_API
+#endif
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/* 1: first release; 2: AUDIODELAY_PARAM_FILTER_SLOPE; 3: spectral mode parameters, audiodelay_get_latency */
+#define AUDIODELAY_API_VERSION 3
+
+    typedef struct AudioDelayEngine AudioDelayEngine;
+
+    typedef enum AudioDelayStatus
+    {
+        AUDIODELAY_OK = 0,
+        AUDIODELAY_ERROR_INVALID_ARGUMENT = -1, /* null engine or buffer, bad channel count, value out of range */
+        AUDIODELAY_ERROR_NOT_PREPARED = -2,     /* process called before prepare */
+        AUDIODELAY_ERROR_UNKNOWN_PARAMETER = -3,
+        AUDIODELAY_ERROR_OUT_OF_MEMORY = -4
+    } AudioDelayStatus;
+
+    /* Values are in the plugin's units and ranges; switches take 0 or 1 */
+    typedef enum AudioDelayParameter
+    {
+        AUDIODELAY_PARAM_DELAY_MS = 0,       /* 0 to 5000 */
+        AUDIODELAY_PARAM_FEEDBACK = 1,       /* 0 to 0.95 */
+        AUDIODELAY_PARAM_MIX = 2,            /* 0 to 1 */
+        AUDIODELAY_PARAM_BITCRUSH = 3,       /* 1 to 16 bits */
+        AUDIODELAY_PARAM_STEREO_WIDTH = 4,   /* 0 to 2 */
+        AUDIODELAY_PARAM_PAN = 5,            /* -1 to 1 */
+        AUDIODELAY_PARAM_HIGHPASS_HZ = 6,    /* 20 to 5000 */
+        AUDIODELAY_PARAM_LOWPASS_HZ = 7,     /* 200 to 20000 */
+        AUDIODELAY_PARAM_LFO_HZ = 8,         /* 0.01 to 20 */
+        AUDIODELAY_PARAM_LFO_AMOUNT = 9,     /* 0 to 1 */
+        AUDIODELAY_PARAM_SMEAR = 10,         /* 0 to 1 */
+        AUDIODELAY_PARAM_WAVESHAPE = 11,     /* 0 to 1 */
+        AUDIODELAY_PARAM_LFO_BITCRUSH = 12,  /* switch */
+        AUDIODELAY_PARAM_LFO_HIGHPASS = 13,  /* switch */
+        AUDIODELAY_PARAM_LFO_LOWPASS = 14,   /* switch */
+        AUDIODELAY_PARAM_LFO_PAN = 15,       /* switch */
+        AUDIODELAY_PARAM_LFO_DELAY = 16,     /* switch */
+        AUDIODELAY_PARAM_DELAY_JUMP = 17,    /* switch */
+        AUDIODELAY_PARAM_NETWORK_LINES = 18, /* 0 (single line), 4, 8 or 16 */
+        AUDIODELAY_PARAM_FREEZE = 19,        /* switch */
+        AUDIODELAY_PARAM_SHIMMER = 20,       /* 0 to 1 */
+        AUDIODELAY_PARAM_SHIMMER_PITCH = 21, /* -12 to 12 semitones */
+        AUDIODELAY_PARAM_REVERSE = 22,       /* switch */
+        AUDIODELAY_PARAM_LFO2_HZ = 23,       /* 0.01 to 20 */
+        AUDIODELAY_PARAM_FILTER_SLOPE = 24,  /* 12, 24, 36 or 48 dB/oct */
+        AUDIODELAY_PARAM_SPECTRAL = 25,      /* switch; adds latency, see audiodelay_get_latency */
+        AUDIODELAY_PARAM_SPECTRAL_HOP = 26,  /* 128, 256, 512 or 1024 samples */
+        AUDIODELAY_PARAM_SPECTRAL_TILT = 27  /* -1 to 1 */
+    } AudioDelayParameter;
+
+    /* Modulation matrix; the values match ModulationRoute in ModulationMatrix.h */
+    typedef enum AudioDelayModSource
+    {
+        AUDIODELAY_MOD_SOURCE_NONE = 0,
+        AUDIODELAY_MOD_SOURCE_LFO1 = 1,
+        AUDIODELAY_MOD_SOURCE_LFO2 = 2,
+        AUDIODELAY_MOD_SOURCE_ENVELOPE = 3
+    } AudioDelayModSource;
+
+    typedef enum AudioDelayModDestination
+    {
+        AUDIODELAY_MOD_DEST_DELAY = 0,
+        AUDIODELAY_MOD_DEST_FEEDBACK = 1,
+        AUDIODELAY_MOD_DEST_MIX = 2,
+        AUDIODELAY_MOD_DEST_BITCRUSH = 3,
+        AUDIODELAY_MOD_DEST_STEREO_WIDTH = 4,
+        AUDIODELAY_MOD_DEST_PAN = 5,
+        AUDIODELAY_MOD_DEST_HIGHPASS = 6,
+        AUDIODELAY_MOD_DEST_LOWPASS = 7,
+        AUDIODELAY_MOD_DEST_SHIMMER = 8
+    } AudioDelayModDestination;
+
+    #define AUDIODELAY_MAX_MOD_ROUTES 4
+
+    AUDIODELAY_API int32_t audiodelay_get_api_version(void);
+
+    /* Null if out of memory. The engine starts with the plugin's default parameters. */
+    AUDIODELAY_API AudioDelayEngine *audiodelay_create(void);
+    AUDIODELAY_API void audiodelay_destroy(AudioDelayEngine *engine);
+
+    /* Allocates everything processing needs; may be called again to change the format */
+    AUDIODELAY_API AudioDelayStatus audiodelay_prepare(AudioDelayEngine *engine, double sample_rate, int32_t max_block_size, int32_t num_channels);
+
+    AUDIODELAY_API AudioDelayStatus audiodelay_set_parameter(AudioDelayEngine *engine, AudioDelayParameter parameter, float value);
+    AUDIODELAY_API AudioDelayStatus audiodelay_get_parameter(const AudioDelayEngine *engine, AudioDelayParameter parameter, float *value);
+
+    /* slot is 0 to AUDIODELAY_MAX_MOD_ROUTES - 1, depth -1 to 1 */
+    AUDIODELAY_API AudioDelayStatus audiodelay_set_mod_route(AudioDelayEngine *engine, int32_t slot, AudioDelayModSource source,
+                                                             AudioDelayModDestination destination, float depth);
+
+    /* Samples the output lags the input for the current parameters; both dry and wet are delayed by it */
+    AUDIODELAY_API AudioDelayStatus audiodelay_get_latency(const AudioDelayEngine *engine, int32_t *latency_samples);
+
+    /* In place. Blocks longer than max_block_size are split internally; neither call allocates. */
+    AUDIODELAY_API AudioDelayStatus audiodelay_process_planar(AudioDelayEngine *engine, float *const *channels, int32_t num_channels, int32_t num_frames);
+    AUDIODELAY_API AudioDelayStatus audiodelay_process_interleaved(AudioDelayEngine *engine, float *samples, int32_t num_channels, int32_t num_frames);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
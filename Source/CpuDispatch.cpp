@@ -0,0 +1,90 @@
+#include "CpuDispatch.h"
+#include <atomic>
+
+namespace
+{
+    std::atomic<int> levelOverride{-1};
+
+    CpuDispatch::Level clampToSupported(CpuDispatch::Level level)
+    {
+        auto supported = CpuDispatch::getSupportedLevel();
+        return static_cast<int>(level) > static_cast<int>(supported) ? supported : level;
+    }
+}
+
+namespace CpuDispatch
+{
+    Level getSupportedLevel()
+    {
+        static const Level supported = []
+        {
+#if AUDIODELAY_X86_KERNELS
+            if (juce::SystemStats::hasAVX512F() && juce::SystemStats::hasFMA3())
+                return Level::AVX512;
+            if (juce::SystemStats::hasAVX2() && juce::SystemStats::hasFMA3())
+                return Level::AVX2;
+#endif
+            return Level::Baseline;
+        }();
+
+        return supported;
+    }
+
+    Level getLevel()
+    {
+        int overridden = levelOverride.load(std::memory_order_relaxed);
+        if (overridden >= 0)
+            return static_cast<Level>(overridden);
+
+        // Read once at startup; changing the variable later has no effect
+        static const Level fromEnvironment = []
+        {
+            Level level = getSupportedLevel();
+            auto requested = juce::SystemStats::getEnvironmentVariable("AUDIODELAY_ISA", {});
+
+            if (requested.isNotEmpty() && !parseLevelName(requested, level))
+                DBG("Ignoring unknown AUDIODELAY_ISA value " << requested);
+
+            return clampToSupported(level);
+        }();
+
+        return fromEnvironment;
+    }
+
+    void setLevelOverride(Level level)
+    {
+        levelOverride.store(static_cast<int>(clampToSupported(level)), std::memory_order_relaxed);
+    }
+
+    void clearLevelOverride()
+    {
+        levelOverride.store(-1, std::memory_order_relaxed);
+    }
+
+    const char *getLevelName(Level level)
+    {
+        switch (level)
+        {
+        case Level::AVX2:
+            return "avx2";
+        case Level::AVX512:
+            return "avx512";
+        default:
+            return "sse2";
+        }
+    }
+
+    bool parseLevelName(const juce::String &name, Level &level)
+    {
+        for (auto candidate : {Level::Baseline, Level::AVX2, Level::AVX512})
+        {
+            if (name.trim().equalsIgnoreCase(getLevelName(candidate)))
+            {
+                level = candidate;
+                return true;
+            }
+        }
+
+        return false;
+    }
+}
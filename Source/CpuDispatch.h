@@ -0,0 +1,29 @@
+#pragma once
+
+#include <juce_core/juce_core.h>
+
+// Picks the instruction set the dispatched kernels run with. Detected once from the CPU on first use;
+// the AUDIODELAY_ISA environment variable (sse2, avx2 or avx512) can force a lower level for testing.
+// Levels the CPU doesn't support are never selected, whatever is requested.
+namespace CpuDispatch
+{
+    enum class Level
+    {
+        Baseline, // SSE2 on x86-64, the target's default elsewhere
+        AVX2,     // AVX2 with FMA
+        AVX512
+    };
+
+    // Highest level this CPU (and build) can run
+    Level getSupportedLevel();
+
+    // Level kernels are selected for: the override if set, else the environment variable, else the supported level
+    Level getLevel();
+
+    // For tools comparing variants; clamped to the supported level. Takes effect for engines prepared afterwards.
+    void setLevelOverride(Level level);
+    void clearLevelOverride();
+
+    const char *getLevelName(Level level);
+    bool parseLevelName(const juce::String &name, Level &level);
+}
@@ -0,0 +1,242 @@
+#pragma once
+
+#include "DSPKernels.h"
+
+// The SSE2 intrinsics are always inlined and never emitted out of line, so they are safe to pull in here
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define AUDIODELAY_SSE2_LANES 1
+#include <emmintrin.h>
+#endif
+
+// Included only by the per-instruction-set kernel files. The unnamed namespace gives every copy
+// internal linkage, so the linker can't swap one file's build of the loop for another's.
+namespace
+{
+    // No branches and no stores the loads could see, so the compiler vectorises the loop at the
+    // width of whatever instruction set the including file is built for
+    template <bool ApplyWidth, typename SampleType>
+    void renderStereoOutputLoop(SampleType *__restrict left, SampleType *__restrict right,
+                                SampleType *__restrict wetLeft, SampleType *__restrict wetRight,
+                                const SampleType *__restrict pan, const SampleType *__restrict mix,
+                                SampleType width, int numSamples)
+    {
+        for (int sample = 0; sample < numSamples; ++sample)
+        {
+            SampleType wetL = wetLeft[sample];
+            SampleType wetR = wetRight[sample];
+
+            if (ApplyWidth)
+            {
+                SampleType mid = (wetL + wetR) * SampleType(0.5);
+                SampleType side = (wetR - wetL) * SampleType(0.5) * width;
+                wetL = mid - side;
+                wetR = mid + side;
+            }
+
+            wetL *= SampleType(0.5) * (SampleType(1) - pan[sample]);
+            wetR *= SampleType(0.5) * (SampleType(1) + pan[sample]);
+            wetLeft[sample] = wetL;
+            wetRight[sample] = wetR;
+
+            left[sample] += mix[sample] * (wetL - left[sample]);
+            right[sample] += mix[sample] * (wetR - right[sample]);
+        }
+    }
+
+    template <typename SampleType>
+    void renderStereoOutput(StereoOutputBlock<SampleType> &block)
+    {
+        if (block.applyWidth)
+            renderStereoOutputLoop<true>(block.left, block.right, block.wetLeft, block.wetRight, block.pan, block.mix, block.width, block.numSamples);
+        else
+            renderStereoOutputLoop<false>(block.left, block.right, block.wetLeft, block.wetRight, block.pan, block.mix, block.width, block.numSamples);
+    }
+
+    // Left and right channel side by side, in double whatever the sample type. x86 always has SSE2,
+    // where the pair fills one register; elsewhere it's a plain pair the compiler is free to pack.
+    struct StereoLanes
+    {
+#if AUDIODELAY_SSE2_LANES
+        using Register = __m128d;
+
+        static Register broadcast(double value) { return _mm_set1_pd(value); }
+        static Register load(const double *left, const double *right) { return _mm_loadh_pd(_mm_load_sd(left), right); }
+        static Register load(const float *left, const float *right) { return _mm_cvtps_pd(_mm_unpacklo_ps(_mm_load_ss(left), _mm_load_ss(right))); }
+        static Register loadPair(const double *pair) { return _mm_loadu_pd(pair); }
+        static void store(Register value, double *left, double *right)
+        {
+            _mm_store_sd(left, value);
+            _mm_storeh_pd(right, value);
+        }
+        static void store(Register value, float *left, float *right)
+        {
+            auto narrowed = _mm_cvtpd_ps(value);
+            _mm_store_ss(left, narrowed);
+            _mm_store_ss(right, _mm_shuffle_ps(narrowed, narrowed, 1));
+        }
+        static void storePair(Register value, double *pair) { _mm_storeu_pd(pair, value); }
+        static Register add(Register a, Register b) { return _mm_add_pd(a, b); }
+        static Register sub(Register a, Register b) { return _mm_sub_pd(a, b); }
+        static Register mul(Register a, Register b) { return _mm_mul_pd(a, b); }
+#else
+        struct Register
+        {
+            double left, right;
+        };
+
+        static Register broadcast(double value) { return {value, value}; }
+        template <typename SampleType>
+        static Register load(const SampleType *left, const SampleType *right) { return {static_cast<double>(*left), static_cast<double>(*right)}; }
+        static Register loadPair(const double *pair) { return {pair[0], pair[1]}; }
+        template <typename SampleType>
+        static void store(Register value, SampleType *left, SampleType *right)
+        {
+            *left = static_cast<SampleType>(value.left);
+            *right = static_cast<SampleType>(value.right);
+        }
+        static void storePair(Register value, double *pair) { store(value, pair, pair + 1); }
+        static Register add(Register a, Register b) { return {a.left + b.left, a.right + b.right}; }
+        static Register sub(Register a, Register b) { return {a.left - b.left, a.right - b.right}; }
+        static Register mul(Register a, Register b) { return {a.left * b.left, a.right * b.right}; }
+#endif
+    };
+
+    template <typename SampleType>
+    void processCascadeMono(CascadeBlock<SampleType> &block)
+    {
+        for (int section = 0; section < block.numSections; ++section)
+        {
+            const double b0 = block.b0[section], b1 = block.b1[section], b2 = block.b2[section];
+            const double a1 = block.a1[section], a2 = block.a2[section];
+            double state1 = block.state1[section * 2];
+            double state2 = block.state2[section * 2];
+            auto *data = block.left;
+
+            for (int sample = 0; sample < block.numSamples; ++sample)
+            {
+                double input = data[sample];
+                double output = b0 * input + state1;
+                state1 = b1 * input - a1 * output + state2;
+                state2 = b2 * input - a2 * output;
+                data[sample] = static_cast<SampleType>(output);
+            }
+
+            block.state1[section * 2] = state1;
+            block.state2[section * 2] = state2;
+        }
+    }
+
+    // Each sample goes through every section before the next is loaded, with left and right as
+    // the lanes of one register, so the stereo pair costs one chain of vector operations
+    template <int NumSections, typename SampleType>
+    void processCascadeStereo(CascadeBlock<SampleType> &block)
+    {
+        using Lanes = StereoLanes;
+        Lanes::Register b0[NumSections], b1[NumSections], b2[NumSections], a1[NumSections], a2[NumSections];
+        Lanes::Register state1[NumSections], state2[NumSections];
+
+        for (int section = 0; section < NumSections; ++section)
+        {
+            b0[section] = Lanes::broadcast(block.b0[section]);
+            b1[section] = Lanes::broadcast(block.b1[section]);
+            b2[section] = Lanes::broadcast(block.b2[section]);
+            a1[section] = Lanes::broadcast(block.a1[section]);
+            a2[section] = Lanes::broadcast(block.a2[section]);
+            state1[section] = Lanes::loadPair(block.state1 + section * 2);
+            state2[section] = Lanes::loadPair(block.state2 + section * 2);
+        }
+
+        auto *left = block.left;
+        auto *right = block.right;
+        for (int sample = 0; sample < block.numSamples; ++sample)
+        {
+            auto x = Lanes::load(left + sample, right + sample);
+
+            for (int section = 0; section < NumSections; ++section)
+            {
+                auto y = Lanes::add(Lanes::mul(b0[section], x), state1[section]);
+                state1[section] = Lanes::add(Lanes::sub(Lanes::mul(b1[section], x), Lanes::mul(a1[section], y)), state2[section]);
+                state2[section] = Lanes::sub(Lanes::mul(b2[section], x), Lanes::mul(a2[section], y));
+                x = y;
+            }
+
+            Lanes::store(x, left + sample, right + sample);
+        }
+
+        for (int section = 0; section < NumSections; ++section)
+        {
+            Lanes::storePair(state1[section], block.state1 + section * 2);
+            Lanes::storePair(state2[section], block.state2 + section * 2);
+        }
+    }
+
+    template <typename SampleType>
+    void processCascade(CascadeBlock<SampleType> &block)
+    {
+        if (block.right == nullptr)
+        {
+            processCascadeMono(block);
+            return;
+        }
+
+        switch (block.numSections)
+        {
+        case 1: processCascadeStereo<1>(block); break;
+        case 2: processCascadeStereo<2>(block); break;
+        case 3: processCascadeStereo<3>(block); break;
+        default: processCascadeStereo<4>(block); break;
+        }
+    }
+
+    // Fixed sizes and restrict pointers let every butterfly stage vectorise across the lines
+    template <int NumLines, typename SampleType>
+    SampleType mixNetworkLines(SampleType *__restrict lines, const SampleType *__restrict gains,
+                               SampleType *__restrict feedback, SampleType normalise)
+    {
+        // Output tap: alternate signs so the sum doesn't just reinforce the input
+        SampleType output = 0;
+        for (int i = 0; i < NumLines; ++i)
+            output += (i & 1) ? -lines[i] : lines[i];
+
+        // Fast Walsh-Hadamard transform, every stage is a run of independent butterflies
+        for (int span = 1; span < NumLines; span *= 2)
+        {
+            for (int start = 0; start < NumLines; start += span * 2)
+            {
+                for (int i = start; i < start + span; ++i)
+                {
+                    auto a = lines[i];
+                    auto b = lines[i + span];
+                    lines[i] = a + b;
+                    lines[i + span] = a - b;
+                }
+            }
+        }
+
+        for (int i = 0; i < NumLines; ++i)
+            feedback[i] = lines[i] * normalise * gains[i];
+
+        return output * normalise;
+    }
+
+    template <typename SampleType>
+    SampleType mixNetworkFrame(NetworkFrame<SampleType> &frame)
+    {
+        switch (frame.numLines)
+        {
+        case 16: return mixNetworkLines<16>(frame.lines, frame.lineGains, frame.feedback, frame.normalise);
+        case 8: return mixNetworkLines<8>(frame.lines, frame.lineGains, frame.feedback, frame.normalise);
+        default: return mixNetworkLines<4>(frame.lines, frame.lineGains, frame.feedback, frame.normalise);
+        }
+    }
+
+    template <typename SampleType>
+    DSPKernels::Table<SampleType> makeTable()
+    {
+        DSPKernels::Table<SampleType> table;
+        table.renderStereoOutput = &renderStereoOutput<SampleType>;
+        table.processCascade = &processCascade<SampleType>;
+        table.mixNetworkFrame = &mixNetworkFrame<SampleType>;
+        return table;
+    }
+}
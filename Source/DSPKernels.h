@@ -0,0 +1,83 @@
+#pragma once
+
+// Deliberately free of JUCE and standard library includes: the kernel files build this with wider
+// instruction sets, and any inline function they pulled in could be merged into baseline callers.
+namespace CpuDispatch
+{
+    enum class Level;
+}
+
+// One sub-block of the stereo output stage: mid/side width, pan gains and dry/wet mix. Plain arrays
+// in and out so the same body can be compiled once per instruction set. Every sample is independent
+// of the others and none of the arrays overlap, so each build runs as many samples per instruction
+// as its registers hold.
+template <typename SampleType>
+struct StereoOutputBlock
+{
+    SampleType *left = nullptr;  // dry in, output out
+    SampleType *right = nullptr;
+    SampleType *wetLeft = nullptr; // wet in, post-pan wet out
+    SampleType *wetRight = nullptr;
+    const SampleType *pan = nullptr; // per sample, filled with the static value when it isn't moving
+    const SampleType *mix = nullptr; // likewise
+    SampleType width = 1;
+    bool applyWidth = false;
+    int numSamples = 0;
+};
+
+// One sub-block through a chain of biquads (transposed direct form II), in place. FilterBank owns
+// the coefficients and state and points in here; both are double, and the samples are widened to
+// double on the way in. The recursion keeps it a sample at a time, so wider builds gain fused
+// multiply-adds rather than more samples per instruction.
+template <typename SampleType>
+struct CascadeBlock
+{
+    SampleType *left = nullptr;
+    SampleType *right = nullptr; // null for mono
+    const double *b0 = nullptr;  // one per section, a0 already divided out
+    const double *b1 = nullptr;
+    const double *b2 = nullptr;
+    const double *a1 = nullptr;
+    const double *a2 = nullptr;
+    double *state1 = nullptr; // per section, left then right
+    double *state2 = nullptr;
+    int numSections = 1; // 1 to 4
+    int numSamples = 0;
+};
+
+// One sample of a feedback delay network: the output tap and the Hadamard mix of the line reads
+// into the next feedback frame. The lines are independent within each butterfly stage, so a frame of
+// 16 float lines fits one AVX-512 register.
+template <typename SampleType>
+struct NetworkFrame
+{
+    SampleType *lines = nullptr;           // this sample's reads; overwritten by the mix
+    const SampleType *lineGains = nullptr; // feedback per line
+    SampleType *feedback = nullptr;        // mixed, normalised and scaled, for the next write
+    SampleType normalise = 1;              // 1 / sqrt(numLines)
+    int numLines = 4;                      // 4, 8 or 16
+};
+
+namespace DSPKernels
+{
+    // Every dispatched kernel for one instruction set
+    template <typename SampleType>
+    struct Table
+    {
+        void (*renderStereoOutput)(StereoOutputBlock<SampleType> &) = nullptr;
+        void (*processCascade)(CascadeBlock<SampleType> &) = nullptr;
+        SampleType (*mixNetworkFrame)(NetworkFrame<SampleType> &) = nullptr; // returns the output tap
+    };
+
+    // One table per instruction set, each defined in its own translation unit built with matching flags
+    template <typename SampleType>
+    Table<SampleType> getBaselineTable();
+    template <typename SampleType>
+    Table<SampleType> getAVX2Table();
+    template <typename SampleType>
+    Table<SampleType> getAVX512Table();
+
+    // Table for the given level; defined with the baseline kernels
+    template <typename SampleType>
+    Table<SampleType> select(CpuDispatch::Level level);
+}
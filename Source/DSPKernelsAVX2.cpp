@@ -0,0 +1,13 @@
+// Built with AVX2 and FMA enabled (see CMakeLists.txt); only called when the CPU reports both
+#include "DSPKernelBody.h"
+
+#if AUDIODELAY_X86_KERNELS
+template <typename SampleType>
+DSPKernels::Table<SampleType> DSPKernels::getAVX2Table()
+{
+    return makeTable<SampleType>();
+}
+
+template DSPKernels::Table<float> DSPKernels::getAVX2Table<float>();
+template DSPKernels::Table<double> DSPKernels::getAVX2Table<double>();
+#endif
@@ -0,0 +1,13 @@
+// Built with AVX-512F enabled (see CMakeLists.txt); only called when the CPU reports it
+#include "DSPKernelBody.h"
+
+#if AUDIODELAY_X86_KERNELS
+template <typename SampleType>
+DSPKernels::Table<SampleType> DSPKernels::getAVX512Table()
+{
+    return makeTable<SampleType>();
+}
+
+template DSPKernels::Table<float> DSPKernels::getAVX512Table<float>();
+template DSPKernels::Table<double> DSPKernels::getAVX512Table<double>();
+#endif
@@ -0,0 +1,27 @@
+// Built with the target's default flags: SSE2 on x86-64, NEON on ARM
+#include "DSPKernelBody.h"
+#include "CpuDispatch.h"
+
+template <typename SampleType>
+DSPKernels::Table<SampleType> DSPKernels::getBaselineTable()
+{
+    return makeTable<SampleType>();
+}
+
+template <typename SampleType>
+DSPKernels::Table<SampleType> DSPKernels::select(CpuDispatch::Level level)
+{
+#if AUDIODELAY_X86_KERNELS
+    if (level == CpuDispatch::Level::AVX512)
+        return getAVX512Table<SampleType>();
+    if (level == CpuDispatch::Level::AVX2)
+        return getAVX2Table<SampleType>();
+#endif
+    juce::ignoreUnused(level);
+    return getBaselineTable<SampleType>();
+}
+
+template DSPKernels::Table<float> DSPKernels::getBaselineTable<float>();
+template DSPKernels::Table<double> DSPKernels::getBaselineTable<double>();
+template DSPKernels::Table<float> DSPKernels::select<float>(CpuDispatch::Level);
+template DSPKernels::Table<double> DSPKernels::select<double>(CpuDispatch::Level);
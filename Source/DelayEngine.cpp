@@ -0,0 +1,940 @@
+#include "DelayEngine.h"
+#include "FastMath.h"
+
+template <typename SampleType>
+DelayEngine<SampleType>::DelayEngine()
+    : sampleRate(44100.0),
+      chorusRate(1.0f),
+      chorusDepth(0.02f),
+      chorusPhase(0.0f),
+      chorusPhaseIncrement(0.0f)
+{
+}
+
+template <typename SampleType>
+void DelayEngine<SampleType>::prepare(const juce::dsp::ProcessSpec &spec, const DelayParameters &params)
+{
+    sampleRate = spec.sampleRate;
+
+    chorusDelayLine.prepare(spec);
+    chorusDelayLine.setMaximumDelayInSamples(static_cast<int>(sampleRate * 0.05 + 3)); // 50 ms + 3 samples for cubic interpolation
+
+    filters.reset();
+    filters.setBiquad(FilterBank<SampleType>::ChorusLowpass, juce::dsp::IIR::ArrayCoefficients<SampleType>::makeLowPass(sampleRate, SampleType(10000)));
+
+    waveShaper.reset();
+
+    delayManager.prepare(spec);
+
+    // Network lines top out at half a second; dense repeats don't need longer and it bounds the memory
+    feedbackNetwork.prepare(spec, 0.5);
+    feedbackNetwork.setNumLines(juce::jmax(4, params.fdnLines));
+
+    // Spectral history covers the longest delay with the tilt holding the top band back an octave
+    // further; a full spectrum per hop comes to 16 bytes per sample, about 8 MB per channel at 48 kHz
+    spectralDelay.setHopSize(params.spectralHop);
+    spectralDelay.prepare(spec, 2.0 * delayManager.getMaximumDelayInSeconds());
+    dryDelayLine.prepare(spec);
+    dryDelayLine.setMaximumDelayInSamples(SpectralDelay<SampleType>::MAX_HOP * SpectralDelay<SampleType>::OVERLAP);
+
+    grainShifter.prepare(spec);
+    grainShifter.setPitch(static_cast<SampleType>(params.shimmerPitch));
+
+    // Everything that works on whole buffers only ever sees one sub-block at a time
+    auto subBlockSpec = spec;
+    subBlockSpec.maximumBlockSize = static_cast<juce::uint32>(SUB_BLOCK_SIZE);
+
+    lfoManager.prepare(subBlockSpec);
+    modulationMatrix.prepare(spec, SUB_BLOCK_SIZE);
+    lfoManager.setFrequency(params.lfoFreq);
+
+    for (int filter = FilterBank<SampleType>::Diffusion1; filter <= FilterBank<SampleType>::Diffusion4; ++filter)
+        filters.setStateVariable(filter, sampleRate, SampleType(1000), SampleType(0.7)); // Set a default cutoff frequency
+    filters.setStateVariable(FilterBank<SampleType>::PreDiffusionLowpass, sampleRate, SampleType(10000));
+    filters.setStateVariable(FilterBank<SampleType>::PostDiffusionLowpass, sampleRate, SampleType(10000));
+
+    filters.setBiquad(FilterBank<SampleType>::DCBlocker, juce::dsp::IIR::ArrayCoefficients<SampleType>::makeHighPass(sampleRate, SampleType(20)));
+
+    filters.setCascade(FilterBank<SampleType>::OutputDCCascade, true, sampleRate, SampleType(5), 1);
+
+    // Chosen here rather than per block so a tool can switch levels between renders
+    kernels = DSPKernels::select<SampleType>(CpuDispatch::getLevel());
+    filters.cascadeKernel = kernels.processCascade;
+    feedbackNetwork.setMixKernel(kernels.mixNetworkFrame);
+
+    chorusPhaseIncrement = static_cast<SampleType>((chorusRate * juce::MathConstants<double>::twoPi) / sampleRate);
+
+    auto numChannels = static_cast<int>(spec.numChannels);
+    wetBuffer.setSize(numChannels, SUB_BLOCK_SIZE);
+    stageScratchBuffer.setSize(numChannels, SUB_BLOCK_SIZE);
+    subBlockPhase = 0;
+    lastReadMode = GlideRead; // so the first block sets up whichever read mode is selected
+
+    lastHighpassCutoff = -1;
+    lastLowpassCutoff = -1;
+    lastFilterSections = -1;
+
+    updateDiffusionFilters(params.smear);
+    applyLFOToFilters(params, SampleType(0), static_cast<SampleType>(params.lfoAmount * 1.5f));
+
+    // Freeze always fades in from the live chain, the same 20ms the loop seam uses
+    freezeFade.reset(sampleRate, 0.02);
+    freezeFade.setCurrentAndTargetValue(SampleType(0));
+
+    // Start every faded stage settled in whatever state the current parameters ask for
+    auto stages = buildActiveStages(params);
+    const bool initialStates[NumFadedStages] = {stages.smear, stages.bitcrush, stages.highpass, stages.lowpass};
+    for (size_t i = 0; i < stageFades.size(); ++i)
+    {
+        stageFades[i].reset(sampleRate, 0.01); // 10ms crossfade when a stage switches in or out
+        stageFades[i].setCurrentAndTargetValue(initialStates[i] ? SampleType(1) : SampleType(0));
+    }
+    latencySamples = stages.readMode == SpectralRead ? spectralDelay.getLatencySamples() : 0;
+    dryLatencyFade.reset(sampleRate, 0.02);
+    dryLatencyFade.setCurrentAndTargetValue(stages.readMode == SpectralRead ? SampleType(1) : SampleType(0));
+
+    // Initialize the delay time after the delayManager has been prepared
+    auto initialDelay = static_cast<SampleType>(params.delay / 1000.0 * sampleRate);
+    delayManager.setDelay(initialDelay);
+
+    delayRamp.reset(sampleRate, 0.05);
+    delayRamp.setCurrentAndTargetValue(initialDelay);
+    feedbackRamp.reset(sampleRate, 0.02);
+    feedbackRamp.setCurrentAndTargetValue(static_cast<SampleType>(params.feedback));
+    mixRamp.reset(sampleRate, 0.02);
+    mixRamp.setCurrentAndTargetValue(static_cast<SampleType>(params.mix));
+    shimmerRamp.reset(sampleRate, 0.02);
+    shimmerRamp.setCurrentAndTargetValue(static_cast<SampleType>(params.shimmer));
+}
+
+template <typename SampleType>
+typename DelayEngine<SampleType>::ActiveStages DelayEngine<SampleType>::buildActiveStages(const DelayParameters &params)
+{
+    ActiveStages stages;
+    modulationMatrix.setRoutes(params.modRoutes);
+
+    // Filter routes modulate by at least half an octave even at zero LFO amount, the others scale with it
+    const bool lfoModulates = params.lfoAmount > 0.0f;
+    stages.lfo = params.lfoHighpass || params.lfoLowpass ||
+                 (lfoModulates && (params.lfoBitcrush || params.lfoPan || params.lfoDelay));
+
+    // In spectral mode smear blurs the spectra instead of running the diffusion filters
+    stages.smear = params.smear > 0.0f && !params.spectral;
+    stages.bitcrush = params.bitcrush < 16.0f || (params.lfoBitcrush && lfoModulates) || modulationMatrix.isRouted(ModulationRoute::Bitcrush);
+
+    // The filter range ends are treated as "off", as is an unmodulated 16 bit crush
+    stages.highpass = params.highpassFreq > 20.0f || params.lfoHighpass || modulationMatrix.isRouted(ModulationRoute::Highpass);
+    stages.lowpass = params.lowpassFreq < 20000.0f || params.lfoLowpass || modulationMatrix.isRouted(ModulationRoute::Lowpass);
+
+    stages.stereoWidth = params.stereoWidth != 1.0f || modulationMatrix.isRouted(ModulationRoute::StereoWidth);
+    stages.panModulation = params.lfoPan && lfoModulates;
+
+    // Jump reads are integer only, so a continuously modulated delay time (LFO, smear chorus or matrix) keeps gliding
+    if (params.spectral)
+        stages.readMode = SpectralRead;
+    else if (params.fdnLines > 0)
+        stages.readMode = NetworkRead;
+    else if (params.reverse)
+        stages.readMode = ReverseRead;
+    else if (params.delayJump && !stages.smear && !(params.lfoDelay && lfoModulates) && !modulationMatrix.isRouted(ModulationRoute::Delay))
+        stages.readMode = JumpRead;
+
+    // The loop is captured as freeze engages; re-engaging before the release fade ends keeps the old loop,
+    // unless the live writes of earlier taps have used up the room behind it
+    if (params.freeze && freezeFade.getTargetValue() == SampleType(0))
+    {
+        if (!isStageRunning(freezeFade) || !delayManager.canResumeFreezeLoop())
+            delayManager.captureFreezeLoop(delayRamp.getCurrentValue());
+        freezeFade.setTargetValue(SampleType(1));
+    }
+    else if (!params.freeze)
+    {
+        freezeFade.setTargetValue(SampleType(0));
+    }
+
+    const bool wanted[NumFadedStages] = {stages.smear, stages.bitcrush, stages.highpass, stages.lowpass};
+    for (size_t i = 0; i < stageFades.size(); ++i)
+    {
+        auto &fade = stageFades[i];
+        SampleType target = wanted[i] ? SampleType(1) : SampleType(0);
+
+        if (target == fade.getTargetValue())
+            continue;
+
+        // A stage coming back from full bypass starts from clean state rather than whatever it held before
+        if (wanted[i] && !isStageRunning(fade))
+            resetFadedStage(static_cast<FadedStage>(i));
+
+        fade.setTargetValue(target);
+    }
+
+    return stages;
+}
+
+template <typename SampleType>
+void DelayEngine<SampleType>::resetFadedStage(FadedStage stage)
+{
+    switch (stage)
+    {
+    case SmearStage:
+        for (int filter = 0; filter < FilterBank<SampleType>::NumStateVariables; ++filter)
+            filters.resetStateVariable(filter);
+        filters.resetBiquad(FilterBank<SampleType>::ChorusLowpass);
+        chorusDelayLine.reset();
+        break;
+    case BitcrushStage:
+        waveShaper.reset();
+        break;
+    case HighpassStage:
+        filters.resetCascade(FilterBank<SampleType>::HighpassCascade);
+        break;
+    case LowpassStage:
+        filters.resetCascade(FilterBank<SampleType>::LowpassCascade);
+        break;
+    default:
+        break;
+    }
+}
+
+template <typename SampleType>
+bool DelayEngine<SampleType>::isStageRunning(const Fade &fade)
+{
+    return fade.isSmoothing() || fade.getTargetValue() > SampleType(0);
+}
+
+template <typename SampleType>
+void DelayEngine<SampleType>::process(juce::AudioBuffer<SampleType> &buffer, int numInputChannels, const DelayParameters &params)
+{
+    auto numSamples = buffer.getNumSamples();
+    const auto stages = buildActiveStages(params);
+
+    if (stages.lfo)
+        lfoManager.setFrequency(params.lfoFreq);
+
+    if (params.smear != lastDiffusionSmear)
+    {
+        DBG("Updating diffusion filters");
+        updateDiffusionFilters(params.smear);
+    }
+
+    setRampTargets(params, stages);
+    grainShifter.setPitch(static_cast<SampleType>(params.shimmerPitch));
+
+    // Start the network from silence rather than whatever it held when it was last switched off,
+    // and the reverse heads on segment boundaries relative to the current write position
+    if (stages.readMode != lastReadMode)
+    {
+        if (stages.readMode == NetworkRead)
+        {
+            feedbackNetwork.reset();
+        }
+        else if (stages.readMode == SpectralRead)
+            spectralDelay.reset();
+        else if (stages.readMode == ReverseRead)
+            delayManager.startReverse(delayRamp.getCurrentValue());
+        lastReadMode = stages.readMode;
+    }
+
+    // The network's line lengths follow the unmodulated delay, crossfading to each new set of lengths
+    if (stages.readMode == NetworkRead)
+    {
+        feedbackNetwork.setNumLines(params.fdnLines);
+        feedbackNetwork.setDelayAndFeedback(static_cast<SampleType>(params.delay / 1000.0 * sampleRate), static_cast<SampleType>(params.feedback));
+    }
+
+    // Band delays follow the unmodulated delay too, whole hops at a time; feedback follows its ramp
+    // per sub-block below
+    if (stages.readMode == SpectralRead)
+    {
+        spectralDelay.setHopSize(params.spectralHop);
+        spectralDelay.setDelayAndFeedback(static_cast<SampleType>(params.delay / 1000.0 * sampleRate), feedbackRamp.getCurrentValue(),
+                                          static_cast<SampleType>(params.spectralTilt));
+        spectralDelay.setSmear(static_cast<SampleType>(params.smear));
+        dryDelayLine.setDelay(static_cast<SampleType>(spectralDelay.getLatencySamples()));
+    }
+    latencySamples = stages.readMode == SpectralRead ? spectralDelay.getLatencySamples() : 0;
+    dryLatencyFade.setTargetValue(stages.readMode == SpectralRead ? SampleType(1) : SampleType(0));
+
+    // Modulation for the whole host block is rendered up front, while the buffer still holds the input
+    const bool modulated = modulationMatrix.hasRoutes();
+    if (modulated)
+        modulationMatrix.process(buffer, numInputChannels, numSamples, subBlockPhase, params.lfoFreq, params.lfo2Freq);
+    DelayParameters modulatedParams;
+
+    // Host blocks are cut into sub-blocks on a fixed grid that carries over between calls, so
+    // control-rate updates land on the same samples whatever block sizes the host uses
+    for (int start = 0, subBlockIndex = 0; start < numSamples; ++subBlockIndex)
+    {
+        int subBlockSize = juce::jmin(SUB_BLOCK_SIZE - subBlockPhase, numSamples - start);
+        juce::AudioBuffer<SampleType> subBlock(buffer.getArrayOfWritePointers(), buffer.getNumChannels(), start, subBlockSize);
+
+        if (modulated)
+        {
+            modulatedParams = params;
+            applyModulation(modulatedParams, subBlockIndex);
+            setRampTargets(modulatedParams, stages);
+        }
+
+        processSubBlock(subBlock, numInputChannels, modulated ? modulatedParams : params, stages, subBlockPhase == 0);
+
+        subBlockPhase = (subBlockPhase + subBlockSize) % SUB_BLOCK_SIZE;
+        start += subBlockSize;
+    }
+}
+
+template <typename SampleType>
+void DelayEngine<SampleType>::setRampTargets(const DelayParameters &params, const ActiveStages &stages)
+{
+    // Jump mode crossfades to the new time itself, so the ramp is skipped
+    auto targetDelay = static_cast<SampleType>(params.delay / 1000.0 * sampleRate);
+    if (stages.readMode == JumpRead)
+        delayRamp.setCurrentAndTargetValue(targetDelay);
+    else
+        delayRamp.setTargetValue(targetDelay);
+    feedbackRamp.setTargetValue(static_cast<SampleType>(params.feedback));
+    mixRamp.setTargetValue(static_cast<SampleType>(params.mix));
+
+    // Grains coming back from silence start clean rather than mid-flight on stale positions
+    if (params.shimmer > 0.0f && !isStageRunning(shimmerRamp))
+        grainShifter.reset();
+    shimmerRamp.setTargetValue(static_cast<SampleType>(params.shimmer));
+
+    // The shaper only runs while its mix is up; coming back, it starts from the next input rather
+    // than whatever it last saw
+    if (params.waveshapeAmount > 0.0f && waveshapeMix <= SampleType(0))
+        waveShaper.reset();
+
+    // Up to 24 dB of drive: the curve's ceiling falls from full scale to 1/16 as the amount goes up
+    waveshapeMix = static_cast<SampleType>(params.waveshapeAmount);
+    waveShaper.setDrive(FastMath::exp2(SampleType(4) * waveshapeMix));
+}
+
+template <typename SampleType>
+void DelayEngine<SampleType>::applyModulation(DelayParameters &params, int subBlock) const
+{
+    auto modulationFor = [this, subBlock](ModulationRoute::Destination destination)
+    {
+        return static_cast<float>(modulationMatrix.getModulation(destination, subBlock));
+    };
+
+    // Full depth moves each destination across most of its useful range: times by half again either way,
+    // cutoffs by four octaves, the rest by their whole range
+    if (modulationMatrix.isRouted(ModulationRoute::Delay))
+        params.delay = juce::jlimit(0.0f, 5000.0f, params.delay * (1.0f + 0.5f * modulationFor(ModulationRoute::Delay)));
+    if (modulationMatrix.isRouted(ModulationRoute::Feedback))
+        params.feedback = juce::jlimit(0.0f, 0.95f, params.feedback + 0.5f * modulationFor(ModulationRoute::Feedback));
+    if (modulationMatrix.isRouted(ModulationRoute::Mix))
+        params.mix = juce::jlimit(0.0f, 1.0f, params.mix + modulationFor(ModulationRoute::Mix));
+    if (modulationMatrix.isRouted(ModulationRoute::Bitcrush))
+        params.bitcrush = juce::jlimit(1.0f, 16.0f, params.bitcrush + 15.0f * modulationFor(ModulationRoute::Bitcrush));
+    if (modulationMatrix.isRouted(ModulationRoute::StereoWidth))
+        params.stereoWidth = juce::jlimit(0.0f, 2.0f, params.stereoWidth + 2.0f * modulationFor(ModulationRoute::StereoWidth));
+    if (modulationMatrix.isRouted(ModulationRoute::Pan))
+        params.pan = juce::jlimit(-1.0f, 1.0f, params.pan + modulationFor(ModulationRoute::Pan));
+    if (modulationMatrix.isRouted(ModulationRoute::Highpass))
+        params.highpassFreq = juce::jlimit(20.0f, 20000.0f, params.highpassFreq * FastMath::exp2(4.0f * modulationFor(ModulationRoute::Highpass)));
+    if (modulationMatrix.isRouted(ModulationRoute::Lowpass))
+        params.lowpassFreq = juce::jlimit(20.0f, 20000.0f, params.lowpassFreq * FastMath::exp2(4.0f * modulationFor(ModulationRoute::Lowpass)));
+    if (modulationMatrix.isRouted(ModulationRoute::Shimmer))
+        params.shimmer = juce::jlimit(0.0f, 1.0f, params.shimmer + modulationFor(ModulationRoute::Shimmer));
+}
+
+template <typename SampleType>
+void DelayEngine<SampleType>::processSubBlock(juce::AudioBuffer<SampleType> &buffer, int numInputChannels, const DelayParameters &params,
+                                              const ActiveStages &stages, bool atControlPoint)
+{
+    auto numSamples = buffer.getNumSamples();
+
+    if (stages.lfo)
+    {
+        StageProfiler::ScopedTimer timer(profiler, StageProfiler::LFOGeneration);
+        lfoManager.generateBlock(numSamples);
+    }
+
+    // The input stays untouched in buffer until the output stage, which reads it as the dry signal
+    wetBuffer.setSize(numInputChannels, numSamples, false, false, true);
+
+    if (atControlPoint && isStageRunning(stageFades[SmearStage]))
+        updateDiffusionModulation();
+
+    if (stages.readMode == SpectralRead)
+        spectralDelay.setFeedback(feedbackRamp.getCurrentValue());
+
+    // Checked per sub-block so writes stop as soon as the freeze fade completes, whatever the host block size
+    const bool frozenLoop = isStageRunning(freezeFade);
+    const bool liveDelay = !params.freeze || freezeFade.isSmoothing();
+
+    DBG("Processing delay and effects");
+    // Process delay and apply effects
+    {
+        StageProfiler::ScopedTimer timer(profiler, StageProfiler::DelayLoop);
+        for (int channel = 0; channel < numInputChannels; ++channel)
+        {
+            auto *inputData = buffer.getReadPointer(channel);
+            auto *wetData = wetBuffer.getWritePointer(channel);
+
+            // Each channel walks the same ramps, the shared state advances once per block below
+            auto smearFade = stageFades[SmearStage];
+            auto bitcrushFade = stageFades[BitcrushStage];
+            auto channelDelay = delayRamp;
+            auto channelFeedback = feedbackRamp;
+            auto channelFreeze = freezeFade;
+            auto channelShimmer = shimmerRamp;
+
+            // Fully frozen: one buffer read per sample, nothing written and no per-repeat processing
+            if (!liveDelay)
+            {
+                for (int sample = 0; sample < numSamples; ++sample)
+                    wetData[sample] = delayManager.popFrozenSample(channel);
+                continue;
+            }
+
+            for (int sample = 0; sample < numSamples; ++sample)
+            {
+                wetData[sample] = processDelayAndEffects(channel, sample, inputData[sample], channelDelay.getNextValue(), channelFeedback.getNextValue(),
+                                                         params, stages, smearFade, bitcrushFade, channelShimmer);
+            }
+
+            if (frozenLoop)
+            {
+                for (int sample = 0; sample < numSamples; ++sample)
+                {
+                    auto frozen = channelFreeze.getNextValue();
+                    wetData[sample] += frozen * (delayManager.popFrozenSample(channel) - wetData[sample]);
+                }
+            }
+        }
+        stageFades[SmearStage].skip(numSamples);
+        stageFades[BitcrushStage].skip(numSamples);
+        delayRamp.skip(numSamples);
+        feedbackRamp.skip(numSamples);
+        freezeFade.skip(numSamples);
+        shimmerRamp.skip(numSamples);
+    }
+
+    {
+        StageProfiler::ScopedTimer timer(profiler, StageProfiler::Filters);
+
+        // Coefficients follow the LFO at control rate, sampled on the sub-block grid
+        if (atControlPoint && (isStageRunning(stageFades[HighpassStage]) || isStageRunning(stageFades[LowpassStage])))
+        {
+            SampleType controlLFO = stages.lfo ? lfoManager.getSample(0) : SampleType(0);
+            applyLFOToFilters(params, controlLFO, static_cast<SampleType>(params.lfoAmount * 1.5f));
+        }
+
+        DBG("Applying filters to wet signal");
+        applyFiltersToWetSignal(wetBuffer, numSamples);
+    }
+
+    {
+        StageProfiler::ScopedTimer timer(profiler, StageProfiler::Output);
+        // The dry signal waits out the spectral frame; the host compensates the output as a whole
+        compensateDryLatency(buffer, numInputChannels);
+
+        DBG("Rendering width, pan, mix and DC block");
+        renderOutput(buffer, numInputChannels, params, stages);
+    }
+}
+
+template <typename SampleType>
+void DelayEngine<SampleType>::compensateDryLatency(juce::AudioBuffer<SampleType> &buffer, int numChannels)
+{
+    const int numSamples = buffer.getNumSamples();
+
+    // The line is fed in every mode, so it already holds the recent input when spectral mode
+    // switches in; the switch then crossfades between the straight and the held-back dry signal
+    // instead of dropping out for a frame, and switching back doesn't jump the dry signal forward
+    const bool fading = dryLatencyFade.isSmoothing();
+    const bool delayed = dryLatencyFade.getTargetValue() > SampleType(0);
+
+    for (int channel = 0; channel < numChannels; ++channel)
+    {
+        auto *data = buffer.getWritePointer(channel);
+        auto channelFade = dryLatencyFade;
+        for (int sample = 0; sample < numSamples; ++sample)
+        {
+            dryDelayLine.pushSample(channel, data[sample]);
+            auto heldBack = dryDelayLine.popSample(channel);
+
+            if (fading)
+                data[sample] += channelFade.getNextValue() * (heldBack - data[sample]);
+            else if (delayed)
+                data[sample] = heldBack;
+        }
+    }
+    dryLatencyFade.skip(numSamples);
+}
+
+template <typename SampleType>
+void DelayEngine<SampleType>::renderOutput(juce::AudioBuffer<SampleType> &buffer, int numWetChannels, const DelayParameters &params, const ActiveStages &stages)
+{
+    const int numSamples = buffer.getNumSamples();
+    const bool ramping = mixRamp.isSmoothing();
+    const SampleType staticMix = mixRamp.getTargetValue();
+
+    // The scope wants the wet signal after width and pan, which the stereo pass leaves in wetBuffer
+    const bool feedScope = scope != nullptr && scope->isActive();
+
+    if (numWetChannels >= 2 && buffer.getNumChannels() >= 2)
+    {
+        // Pan and mix go in as arrays either way, so the kernel's loop has nothing to branch on;
+        // the scratch buffer is free once the filters are done
+        stageScratchBuffer.setSize(stageScratchBuffer.getNumChannels(), numSamples, false, false, true);
+        SampleType *panValues = stageScratchBuffer.getWritePointer(0);
+        const SampleType basePan = static_cast<SampleType>(params.pan);
+        if (stages.panModulation)
+        {
+            const SampleType lfoAmount = static_cast<SampleType>(params.lfoAmount);
+            for (int sample = 0; sample < numSamples; ++sample)
+                panValues[sample] = applyLFOToPan(basePan, lfoAmount, lfoManager.getSample(sample));
+        }
+        else
+        {
+            std::fill(panValues, panValues + numSamples, basePan);
+        }
+
+        SampleType *mixValues = stageScratchBuffer.getWritePointer(1);
+        if (ramping)
+        {
+            for (int sample = 0; sample < numSamples; ++sample)
+                mixValues[sample] = mixRamp.getNextValue();
+        }
+        else
+        {
+            std::fill(mixValues, mixValues + numSamples, staticMix);
+        }
+
+        outputBlock.left = buffer.getWritePointer(0);
+        outputBlock.right = buffer.getWritePointer(1);
+        outputBlock.wetLeft = wetBuffer.getWritePointer(0);
+        outputBlock.wetRight = wetBuffer.getWritePointer(1);
+        outputBlock.pan = panValues;
+        outputBlock.mix = mixValues;
+        outputBlock.width = static_cast<SampleType>(params.stereoWidth);
+        outputBlock.applyWidth = stages.stereoWidth; // width at 1 is the identity
+        outputBlock.numSamples = numSamples;
+
+        // Width, pan and mix first, while the sub-block is still in cache; the DC recursion
+        // then runs over the result with left and right packed in one register
+        kernels.renderStereoOutput(outputBlock);
+        filters.processCascade(FilterBank<SampleType>::OutputDCCascade, outputBlock.left, outputBlock.right, numSamples);
+    }
+    else
+    {
+        // Mono: no width or pan, just the mix per channel, then the DC block
+        const int numMixedChannels = juce::jmin(numWetChannels, 2);
+        for (int channel = 0; channel < numMixedChannels; ++channel)
+        {
+            auto *wetData = wetBuffer.getReadPointer(channel);
+            auto *outputData = buffer.getWritePointer(channel);
+            auto channelMix = mixRamp;
+
+            for (int sample = 0; sample < numSamples; ++sample)
+            {
+                SampleType mix = ramping ? channelMix.getNextValue() : staticMix;
+                outputData[sample] += mix * (wetData[sample] - outputData[sample]);
+            }
+        }
+
+        if (ramping)
+            mixRamp.skip(numSamples);
+
+        if (numMixedChannels > 0)
+            filters.processCascade(FilterBank<SampleType>::OutputDCCascade, buffer.getWritePointer(0),
+                                   numMixedChannels > 1 ? buffer.getWritePointer(1) : nullptr, numSamples);
+    }
+
+    if (feedScope)
+        scope->pushBlock(wetBuffer, numSamples);
+}
+
+template <typename SampleType>
+void DelayEngine<SampleType>::updateDiffusionFilters(float smearAmount)
+{
+    float rate = static_cast<float>(sampleRate);
+
+    // Adjust diffusion curve: start medium, then decrease as smear increases
+    float diffusionCurve = 0.5f * (1.0f - std::pow(smearAmount, 0.5f));
+
+    float delayTimes[4] = {0.0007f, 0.0011f, 0.0013f, 0.0017f}; // in seconds
+    float maxFeedbackAmounts[4] = {0.3f, 0.35f, 0.4f, 0.45f};   // Maximum feedback amounts
+
+    for (size_t i = 0; i < 4; ++i)
+    {
+        float delayTime = juce::jmax(0.00001f, delayTimes[i]);
+        float feedback = maxFeedbackAmounts[i] * diffusionCurve;
+
+        float frequency = juce::jlimit(20.0f, rate * 0.49f, 1.0f / delayTime);
+        float q = juce::jlimit(0.01f, 10.0f, 1.0f / (2.0f * (1.0f - feedback))); // Reduced maximum Q
+
+        diffusionBaseFrequencies[i] = static_cast<SampleType>(frequency);
+        filters.setStateVariable(FilterBank<SampleType>::Diffusion1 + static_cast<int>(i), sampleRate, static_cast<SampleType>(frequency), static_cast<SampleType>(q));
+    }
+
+    lastDiffusionSmear = smearAmount;
+
+    // Update pre and post diffusion lowpass filters
+    float lowpassFreq = juce::jmap(smearAmount, 20000.0f, 10000.0f);
+    filters.setCutoff(FilterBank<SampleType>::PreDiffusionLowpass, sampleRate, static_cast<SampleType>(lowpassFreq));
+    filters.setCutoff(FilterBank<SampleType>::PostDiffusionLowpass, sampleRate, static_cast<SampleType>(lowpassFreq));
+
+    // Update chorus parameters
+    if (smearAmount > 0.0f)
+    {
+        // Slower increase in chorus rate
+        chorusRate = static_cast<SampleType>(0.2f + smearAmount * 0.8f); // Chorus rate from 0.2 Hz to 1.0 Hz
+
+        // More subtle increase in chorus depth
+        chorusDepth = static_cast<SampleType>(std::pow(smearAmount, 1.5f) * 0.005f); // Non-linear increase, up to 5 ms
+
+        chorusPhaseIncrement = static_cast<SampleType>((chorusRate * juce::MathConstants<double>::twoPi) / sampleRate);
+
+        // Update chorus lowpass filter in place, smear can change every block while morphing
+        float chorusCutoff = juce::jmap(smearAmount, 10000.0f, 15000.0f);
+        filters.setBiquad(FilterBank<SampleType>::ChorusLowpass, juce::dsp::IIR::ArrayCoefficients<SampleType>::makeLowPass(sampleRate, static_cast<SampleType>(chorusCutoff)));
+
+        DBG("Chorus parameters updated - Rate: " << chorusRate << " Hz, Depth: " << chorusDepth << ", Cutoff: " << chorusCutoff << " Hz");
+    }
+    else
+    {
+        chorusRate = 0;
+        chorusDepth = 0;
+        chorusPhaseIncrement = 0;
+        DBG("Chorus disabled");
+    }
+
+    DBG("Diffusion filters updated - Smear Amount: " << smearAmount
+                                                     << ", Diffusion Curve: " << diffusionCurve
+                                                     << ", Pre/Post Lowpass Freq: " << lowpassFreq
+                                                     << ", Diffusion Filter 0 Freq: " << diffusionBaseFrequencies[0]);
+}
+
+template <typename SampleType>
+void DelayEngine<SampleType>::updateDiffusionModulation()
+{
+    // Modulate around the base cutoffs with the chorus LFO, once per sub-block rather than per sample
+    SampleType chorusModulation = chorusDepth * (FastMath::sin(chorusPhase) * SampleType(0.5) + SampleType(0.5));
+
+    for (size_t i = 0; i < diffusionBaseFrequencies.size(); ++i)
+        filters.setCutoff(FilterBank<SampleType>::Diffusion1 + static_cast<int>(i), sampleRate, diffusionBaseFrequencies[i] * (SampleType(1) + chorusModulation * SampleType(0.1)));
+}
+
+template <typename SampleType>
+SampleType DelayEngine<SampleType>::processDiffusionFilters(SampleType input, int channel, SampleType smearAmount)
+{
+    if (smearAmount <= SampleType(0))
+    {
+        return input;
+    }
+
+    SampleType output = filters.processLowpass(FilterBank<SampleType>::PreDiffusionLowpass, channel, input);
+
+    // Improved chorus effect
+    const auto pi = juce::MathConstants<SampleType>::pi;
+    const auto twoPi = juce::MathConstants<SampleType>::twoPi;
+    SampleType chorusModulation = chorusDepth * (FastMath::sin(chorusPhase + (static_cast<SampleType>(channel) * pi * SampleType(0.5))) * SampleType(0.5) + SampleType(0.5));
+    if (channel == 0)
+    {
+        chorusPhase += chorusPhaseIncrement;
+        if (chorusPhase >= twoPi)
+            chorusPhase -= twoPi;
+    }
+
+    // Use smoother interpolation for chorus
+    SampleType delayInSamples = chorusModulation * static_cast<SampleType>(sampleRate);
+    SampleType chorusOutput = chorusDelayLine.popSample(channel, delayInSamples, true); // Use internal interpolation
+
+    chorusDelayLine.pushSample(channel, input);
+
+    // Apply lowpass filter to chorus output
+    chorusOutput = filters.processBiquad(FilterBank<SampleType>::ChorusLowpass, 0, chorusOutput);
+
+    // Cutoff modulation happens at control rate in updateDiffusionModulation
+    for (int filter = FilterBank<SampleType>::Diffusion1; filter <= FilterBank<SampleType>::Diffusion4; ++filter)
+        output = filters.processBandpass(filter, channel, output);
+
+    output = filters.processLowpass(FilterBank<SampleType>::PostDiffusionLowpass, channel, output);
+
+    // Smooth mixing of dry, chorus, and diffused signals
+    SampleType wetAmount = smearAmount;
+    SampleType dryAmount = SampleType(1) - wetAmount;
+
+    SampleType mixedOutput = input * dryAmount + (chorusOutput * SampleType(0.6) + output * SampleType(0.4)) * wetAmount;
+
+    return mixedOutput;
+}
+
+template <typename SampleType>
+void DelayEngine<SampleType>::applyLFOToFilters(const DelayParameters &params, SampleType smoothedLFO, SampleType lfoAmount)
+{
+    SampleType baseHighpassFreq = static_cast<SampleType>(params.highpassFreq);
+    SampleType baseLowpassFreq = static_cast<SampleType>(params.lowpassFreq);
+    SampleType modifiedHighpassFreq = baseHighpassFreq;
+    SampleType modifiedLowpassFreq = baseLowpassFreq;
+
+    if (params.lfoHighpass)
+    {
+        // Increase the modulation range for highpass
+        SampleType highpassModDepth = juce::jmap(lfoAmount, SampleType(0.5), SampleType(6));
+        modifiedHighpassFreq = juce::jlimit(
+            SampleType(20),
+            SampleType(5000),
+            baseHighpassFreq * FastMath::exp2(highpassModDepth * (smoothedLFO * SampleType(2) - SampleType(1))));
+    }
+
+    if (params.lfoLowpass)
+    {
+        // Increase the modulation range for lowpass
+        SampleType lowpassModDepth = juce::jmap(lfoAmount, SampleType(0.5), SampleType(4));
+        modifiedLowpassFreq = juce::jlimit(
+            SampleType(200),
+            SampleType(20000),
+            baseLowpassFreq * FastMath::exp2(lowpassModDepth * (smoothedLFO * SampleType(2) - SampleType(1))));
+    }
+
+    // Only redesign when a cutoff or the slope actually moved; ArrayCoefficients returns plain
+    // arrays, so a morph sweep never allocates
+    int numSections = juce::jlimit(1, static_cast<int>(FilterBank<SampleType>::MAX_CASCADE_SECTIONS), params.filterSlope / 12);
+    bool slopeChanged = numSections != lastFilterSections;
+    lastFilterSections = numSections;
+
+    if (slopeChanged || modifiedHighpassFreq != lastHighpassCutoff)
+    {
+        filters.setCascade(FilterBank<SampleType>::HighpassCascade, true, sampleRate, modifiedHighpassFreq, numSections);
+        lastHighpassCutoff = modifiedHighpassFreq;
+    }
+
+    if (slopeChanged || modifiedLowpassFreq != lastLowpassCutoff)
+    {
+        filters.setCascade(FilterBank<SampleType>::LowpassCascade, false, sampleRate, modifiedLowpassFreq, numSections);
+        lastLowpassCutoff = modifiedLowpassFreq;
+    }
+}
+
+template <typename SampleType>
+void DelayEngine<SampleType>::updateChorusPhase()
+{
+    chorusPhase += chorusPhaseIncrement;
+    if (chorusPhase >= juce::MathConstants<SampleType>::twoPi)
+        chorusPhase -= juce::MathConstants<SampleType>::twoPi;
+}
+
+template <typename SampleType>
+SampleType DelayEngine<SampleType>::applyLFOToBitcrush(SampleType bitcrushAmount, SampleType lfoAmount, SampleType smoothedLFO, bool lfoBitcrush)
+{
+    if (lfoBitcrush)
+    {
+        return applyLFO(bitcrushAmount, lfoAmount, smoothedLFO, SampleType(1), SampleType(16));
+    }
+    return bitcrushAmount;
+}
+
+template <typename SampleType>
+SampleType DelayEngine<SampleType>::processDelaySample(int channel, SampleType delayInSamples, SampleType smearAmount, SampleType lfoModulation, ReadMode readMode, Fade &smearFade)
+{
+    SampleType delaySample;
+
+    if (readMode == NetworkRead)
+    {
+        // The network recirculates internally; this is just its output tap
+        delaySample = feedbackNetwork.popSample(channel);
+    }
+    else if (readMode == SpectralRead)
+    {
+        // Likewise the bands recirculate inside the STFT; this is the resynthesised output
+        delaySample = spectralDelay.popSample(channel);
+    }
+    else if (readMode == ReverseRead)
+    {
+        // Segments follow the delay time as each one starts; modulation is not applied to backwards reads
+        delaySample = delayManager.popSampleReverse(channel, delayInSamples);
+    }
+    else if (readMode == JumpRead)
+    {
+        // Unmodulated delay: integer read heads, crossfaded when the time changes
+        delaySample = delayManager.popSampleJump(channel, delayInSamples);
+    }
+    else
+    {
+        // Apply LFO modulation to delay time
+        SampleType lfoModulatedDelay = delayInSamples * (SampleType(1) + lfoModulation);
+
+        // Apply additional chorusing based on smear amount
+        SampleType chorusModulation = chorusDepth * FastMath::sin(chorusPhase) * smearAmount;
+        SampleType totalModulatedDelay = lfoModulatedDelay * (SampleType(1) + chorusModulation);
+
+        // Get the delayed sample
+        delaySample = delayManager.popSample(channel, totalModulatedDelay);
+    }
+
+    // Apply diffusion while smear is active or still fading out
+    if (isStageRunning(smearFade))
+    {
+        SampleType fade = smearFade.getNextValue();
+        SampleType diffusedSample = processDiffusionFilters(delaySample, channel, smearAmount);
+        diffusedSample = juce::jmap(smearAmount, delaySample, diffusedSample);
+        delaySample += fade * (diffusedSample - delaySample);
+    }
+
+    return delaySample;
+}
+
+template <typename SampleType>
+void DelayEngine<SampleType>::applyFiltersToWetSignal(juce::AudioBuffer<SampleType> &wet, int numSamples)
+{
+    applyFilterStage(FilterBank<SampleType>::HighpassCascade, stageFades[HighpassStage], wet, numSamples);
+    applyFilterStage(FilterBank<SampleType>::LowpassCascade, stageFades[LowpassStage], wet, numSamples);
+}
+
+template <typename SampleType>
+void DelayEngine<SampleType>::applyFilterStage(int cascade, Fade &fade, juce::AudioBuffer<SampleType> &wet, int numSamples)
+{
+    if (!isStageRunning(fade))
+        return;
+
+    auto *left = wet.getWritePointer(0);
+    auto *right = wet.getNumChannels() > 1 ? wet.getWritePointer(1) : nullptr;
+
+    if (!fade.isSmoothing())
+    {
+        filters.processCascade(cascade, left, right, numSamples);
+        return;
+    }
+
+    // Mid-transition: keep the unfiltered signal around and blend towards the filtered one
+    stageScratchBuffer.setSize(wet.getNumChannels(), numSamples, false, false, true);
+    for (int channel = 0; channel < wet.getNumChannels(); ++channel)
+        stageScratchBuffer.copyFrom(channel, 0, wet, channel, 0, numSamples);
+
+    filters.processCascade(cascade, left, right, numSamples);
+
+    for (int channel = 0; channel < wet.getNumChannels(); ++channel)
+    {
+        auto channelFade = fade;
+        auto *wetData = wet.getWritePointer(channel);
+        auto *bypassData = stageScratchBuffer.getReadPointer(channel);
+
+        for (int sample = 0; sample < numSamples; ++sample)
+            wetData[sample] = bypassData[sample] + channelFade.getNextValue() * (wetData[sample] - bypassData[sample]);
+    }
+    fade.skip(numSamples);
+}
+
+template <typename SampleType>
+SampleType DelayEngine<SampleType>::processDelayAndEffects(int channel, int sample, SampleType inputSample, SampleType delayInSamples, SampleType feedback,
+                                                           const DelayParameters &params, const ActiveStages &stages, Fade &smearFade, Fade &bitcrushFade, Fade &shimmerFade)
+{
+    SampleType smoothedLFO = stages.lfo ? lfoManager.getSample(sample) : SampleType(0);
+
+    // Apply a global LFO depth control
+    SampleType globalLFODepth = SampleType(1.5); // Adjust this value to increase overall LFO impact
+    SampleType enhancedLFOAmount = static_cast<SampleType>(params.lfoAmount) * globalLFODepth;
+
+    // Calculate LFO modulation for delay
+    SampleType lfoModulation = 0;
+    if (params.lfoDelay)
+    {
+        lfoModulation = smoothedLFO * enhancedLFOAmount * SampleType(0.2);
+    }
+
+    // Process delay sample with both LFO modulation and smear (diffusion and chorus)
+    SampleType delaySample = processDelaySample(channel, delayInSamples, static_cast<SampleType>(params.smear), lfoModulation, stages.readMode, smearFade);
+
+    // Shimmer: pitch-shifted grains of the same stretch of the ring take over part of the repeat, so
+    // every pass through the feedback loop climbs (or falls) by another interval
+    if (isStageRunning(shimmerFade))
+    {
+        SampleType amount = shimmerFade.getNextValue();
+        SampleType shifted = grainShifter.processSample(channel, delayInSamples, delayManager);
+        delaySample += amount * (shifted - delaySample);
+    }
+
+    // Apply bitcrushing to the delayed signal
+    if (isStageRunning(bitcrushFade))
+    {
+        SampleType fade = bitcrushFade.getNextValue();
+        SampleType modifiedBitcrush = applyLFOToBitcrush(static_cast<SampleType>(params.bitcrush), enhancedLFOAmount, smoothedLFO, params.lfoBitcrush);
+
+        // 16 bits only decides whether the stage starts; fading out, the crush keeps its last depth
+        // so the fade has something to ramp down
+        if (modifiedBitcrush < SampleType(16))
+            lastCrushDepth[channel] = modifiedBitcrush;
+        else if (bitcrushFade.getTargetValue() <= SampleType(0))
+            modifiedBitcrush = lastCrushDepth[channel];
+
+        if (modifiedBitcrush < SampleType(16))
+        {
+            SampleType crushedSample = applyBitcrushing(channel, delaySample, modifiedBitcrush);
+            delaySample += fade * (crushedSample - delaySample);
+        }
+    }
+
+    // Apply DC blocking filter to the delayed sample
+    delaySample = filters.processBiquad(FilterBank<SampleType>::DCBlocker, channel, delaySample);
+
+    // The single line keeps running under the network and the spectral delay so switching back picks up where it was
+    delayManager.pushSample(channel, inputSample + (delaySample * feedback));
+    if (stages.readMode == NetworkRead)
+        feedbackNetwork.pushSample(channel, inputSample);
+    else if (stages.readMode == SpectralRead)
+        spectralDelay.pushSample(channel, inputSample);
+
+    if (stages.smear)
+        updateChorusPhase();
+
+    // Debug output (if needed)
+    if (sample == 0)
+    {
+        DBG("Channel " << channel << " - Sample 0:");
+        DBG("  Input: " << inputSample << ", Output: " << delaySample);
+        DBG("  LFO: " << smoothedLFO << ", Enhanced Amount: " << enhancedLFOAmount);
+        DBG("  Smear Amount: " << params.smear << ", LFO Modulation: " << lfoModulation);
+    }
+
+    return delaySample;
+}
+
+template <typename SampleType>
+SampleType DelayEngine<SampleType>::applyBitcrushing(int channel, SampleType sample, SampleType bitcrushAmount)
+{
+    int bits = static_cast<int>(bitcrushAmount);
+    // Integer exponent, so the fast exp2 is exact here
+    SampleType maxValue = FastMath::exp2(static_cast<SampleType>(bits)) - SampleType(1);
+    SampleType crushedSample = FastMath::round(sample * maxValue) / maxValue;
+
+    if (waveshapeMix <= SampleType(0))
+        return crushedSample;
+
+    // Mix between crushed and shaped sample
+    SampleType shapedSample = waveShaper.processSample(channel, crushedSample);
+    return crushedSample + waveshapeMix * (shapedSample - crushedSample);
+}
+
+template <typename SampleType>
+SampleType DelayEngine<SampleType>::applyLFO(SampleType baseValue, SampleType lfoAmount, SampleType lfoValue, SampleType minValue, SampleType maxValue)
+{
+    SampleType range = maxValue - minValue;
+    SampleType modulation = lfoValue * lfoAmount * range * SampleType(0.5);
+    return juce::jlimit(minValue, maxValue, baseValue + modulation);
+}
+
+template <typename SampleType>
+SampleType DelayEngine<SampleType>::applyLFOToPan(SampleType basePan, SampleType lfoAmount, SampleType lfoValue)
+{
+    // Assume lfoValue is in the range [0, 1]
+    // Convert it to the range [-1, 1]
+    SampleType bipolarLFO = SampleType(2) * lfoValue - SampleType(1);
+
+    // Calculate the modulation, scaling it by lfoAmount
+    SampleType modulation = bipolarLFO * lfoAmount;
+
+    // Apply the modulation to the base pan
+    // This ensures that when basePan is 0 (center), the LFO modulates equally in both directions
+    SampleType modifiedPan = basePan + (SampleType(1) - std::abs(basePan)) * modulation;
+
+    // Limit the result to the valid range [-1, 1]
+    return juce::jlimit(SampleType(-1), SampleType(1), modifiedPan);
+}
+
+template class DelayEngine<float>;
+template class DelayEngine<double>;
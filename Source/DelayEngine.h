@@ -0,0 +1,206 @@
+#pragma once
+
+#include <juce_dsp/juce_dsp.h>
+#include <array>
+#include "LFOManager.h"
+#include "DelayManager.h"
+#include "StageProfiler.h"
+#include "ScopeFifo.h"
+#include "FeedbackDelayNetwork.h"
+#include "GrainShifter.h"
+#include "ModulationMatrix.h"
+#include "CpuDispatch.h"
+#include "DSPKernels.h"
+#include "FilterBank.h"
+#include "Waveshaper.h"
+#include "SpectralDelay.h"
+
+// Plain copy of every parameter the DSP chain reads, taken once per block.
+// Defaults match createParameterLayout so tools can render without a processor.
+struct DelayParameters
+{
+    float delay = 500.0f; // milliseconds
+    float feedback = 0.5f;
+    float mix = 0.5f;
+    float bitcrush = 16.0f;
+    float stereoWidth = 1.0f;
+    float pan = 0.0f;
+    float highpassFreq = 20.0f;
+    float lowpassFreq = 20000.0f;
+    float lfoFreq = 1.0f;
+    float lfoAmount = 0.0f;
+    float smear = 0.0f;
+    float waveshapeAmount = 0.5f;
+    bool lfoBitcrush = false;
+    bool lfoHighpass = false;
+    bool lfoLowpass = false;
+    bool lfoPan = false;
+    bool lfoDelay = false;
+    bool delayJump = false; // crossfade between read heads instead of gliding the delay time
+    int fdnLines = 0;       // 0 for the single delay line per channel, otherwise 4, 8 or 16 network lines
+    bool freeze = false;    // loop the delay buffer as it stands instead of processing new repeats
+    float shimmer = 0.0f;       // share of each repeat replaced by its pitch-shifted grains
+    float shimmerPitch = 12.0f; // semitones
+    bool reverse = false;       // play each delay-length segment backwards
+    float lfo2Freq = 0.5f;      // Hz, the modulation matrix's second LFO
+    int filterSlope = 12;       // dB/oct of the wet highpass and lowpass: 12, 24, 36 or 48
+    bool spectral = false;      // STFT spectral delay instead of the delay line; smear then blurs spectra
+    int spectralHop = 256;      // samples between STFT frames: 128, 256, 512 or 1024; the latency is four hops
+    float spectralTilt = 0.0f;  // -1 to 1, spreads the spectral delay an octave either side across the bands
+    ModulationRoutes modRoutes{};
+};
+
+// The whole wet chain (delay, feedback loop, smear, filters and output stages),
+// templated so the processor can run it natively in float or double.
+template <typename SampleType>
+class DelayEngine
+{
+public:
+    DelayEngine();
+    void prepare(const juce::dsp::ProcessSpec &spec, const DelayParameters &params);
+    void process(juce::AudioBuffer<SampleType> &buffer, int numInputChannels, const DelayParameters &params);
+
+    // Host blocks are processed in sub-blocks of this size; control-rate updates run once per sub-block
+    static const int SUB_BLOCK_SIZE = 32;
+
+    DelayManager<SampleType> &getDelayManager() { return delayManager; }
+    LFOManager<SampleType> &getLFOManager() { return lfoManager; }
+
+    // Optional; stages are timed into it while it is enabled
+    void setProfiler(StageProfiler *profilerToUse) { profiler = profilerToUse; }
+
+    // Optional; receives the wet signal after panning, before the dry/wet mix
+    void setScope(ScopeFifo *scopeToFeed) { scope = scopeToFeed; }
+
+    // Samples the whole output (dry included, so they stay aligned) lags the input; non-zero only in
+    // spectral mode. Follows the parameters of the last block processed, for the host's delay compensation.
+    int getLatencySamples() const { return latencySamples; }
+
+private:
+    // Where the delayed sample comes from
+    enum ReadMode
+    {
+        GlideRead,   // fractional read, delay changes sweep the read position
+        JumpRead,    // integer read heads crossfaded on delay changes
+        ReverseRead, // delay-length segments played backwards
+        NetworkRead, // feedback delay network output
+        SpectralRead // STFT frames delayed per band
+    };
+
+    // Stages that are not identity for the current parameters; everything else is skipped
+    struct ActiveStages
+    {
+        bool lfo = false;
+        bool smear = false;
+        bool bitcrush = false;
+        bool highpass = false;
+        bool lowpass = false;
+        bool stereoWidth = false;
+        bool panModulation = false;
+        ReadMode readMode = GlideRead;
+    };
+
+    // Stateful stages that crossfade in and out instead of switching abruptly
+    enum FadedStage
+    {
+        SmearStage,
+        BitcrushStage,
+        HighpassStage,
+        LowpassStage,
+        NumFadedStages
+    };
+
+    using Fade = juce::SmoothedValue<SampleType>;
+
+    ActiveStages buildActiveStages(const DelayParameters &params);
+    void processSubBlock(juce::AudioBuffer<SampleType> &buffer, int numInputChannels, const DelayParameters &params,
+                         const ActiveStages &stages, bool atControlPoint);
+    void setRampTargets(const DelayParameters &params, const ActiveStages &stages);
+    void applyModulation(DelayParameters &params, int subBlock) const;
+    void resetFadedStage(FadedStage stage);
+    static bool isStageRunning(const Fade &fade);
+    SampleType processDelayAndEffects(int channel, int sample, SampleType inputSample, SampleType delayInSamples, SampleType feedback,
+                                      const DelayParameters &params, const ActiveStages &stages, Fade &smearFade, Fade &bitcrushFade, Fade &shimmerFade);
+    SampleType applyLFOToBitcrush(SampleType bitcrushAmount, SampleType lfoAmount, SampleType smoothedLFO, bool lfoBitcrush);
+    void applyLFOToFilters(const DelayParameters &params, SampleType smoothedLFO, SampleType lfoAmount);
+    SampleType processDelaySample(int channel, SampleType delayInSamples, SampleType smearAmount, SampleType lfoModulation, ReadMode readMode, Fade &smearFade);
+    void updateChorusPhase();
+    void applyFiltersToWetSignal(juce::AudioBuffer<SampleType> &wetBuffer, int numSamples);
+    void applyFilterStage(int cascade, Fade &fade, juce::AudioBuffer<SampleType> &wetBuffer, int numSamples);
+    void compensateDryLatency(juce::AudioBuffer<SampleType> &buffer, int numChannels);
+    void renderOutput(juce::AudioBuffer<SampleType> &buffer, int numWetChannels, const DelayParameters &params, const ActiveStages &stages);
+    void updateDiffusionFilters(float smearAmount);
+    void updateDiffusionModulation();
+    SampleType processDiffusionFilters(SampleType input, int channel, SampleType smearAmount);
+    SampleType applyBitcrushing(int channel, SampleType sample, SampleType bitcrushAmount);
+    SampleType applyLFO(SampleType baseValue, SampleType lfoAmount, SampleType lfoValue, SampleType minValue, SampleType maxValue);
+    SampleType applyLFOToPan(SampleType basePan, SampleType lfoAmount, SampleType lfoValue);
+
+    LFOManager<SampleType> lfoManager;
+    DelayManager<SampleType> delayManager;
+    FeedbackDelayNetwork<SampleType> feedbackNetwork;
+    SpectralDelay<SampleType> spectralDelay;
+    GrainShifter<SampleType> grainShifter;
+    ModulationMatrix<SampleType> modulationMatrix;
+
+    // Saturation after the bitcrusher. The curve is chosen here, at compile time, from Waveshapes;
+    // waveshapeAmount sets its drive and how much of it is mixed in.
+    using SaturationShape = Waveshapes::HardClip;
+    AntialiasedWaveshaper<SampleType, SaturationShape> waveShaper;
+    SampleType waveshapeMix = 0;
+
+    // Depth the bitcrusher last ran at, per channel, held while the stage fades out after the
+    // parameter has already returned to 16 bits
+    SampleType lastCrushDepth[FilterBank<SampleType>::NUM_CHANNELS] = {15, 15};
+
+    juce::dsp::DelayLine<SampleType, juce::dsp::DelayLineInterpolationTypes::Linear> chorusDelayLine;
+
+    // Holds the dry signal back by the spectral frame so it lines up with the wet one
+    juce::dsp::DelayLine<SampleType, juce::dsp::DelayLineInterpolationTypes::None> dryDelayLine;
+    int latencySamples = 0;
+
+    static const int NUM_DIFFUSION_FILTERS = 4;
+
+    // Diffusion, chorus, DC blocker and wet filter state in one aligned block the audio thread owns
+    FilterBank<SampleType> filters;
+
+    // Output pass, filter cascades and network mix, dispatched to the best instruction set in prepare
+    StereoOutputBlock<SampleType> outputBlock;
+    DSPKernels::Table<SampleType> kernels;
+
+    std::array<SampleType, NUM_DIFFUSION_FILTERS> diffusionBaseFrequencies{};
+    float lastDiffusionSmear = -1.0f;
+    SampleType lastHighpassCutoff = -1;
+    SampleType lastLowpassCutoff = -1;
+    int lastFilterSections = -1;
+    int subBlockPhase = 0; // samples into the current sub-block, carried across host blocks
+    ReadMode lastReadMode = GlideRead;
+
+    std::array<Fade, NumFadedStages> stageFades;
+
+    // Per-sample ramps for the continuous values the sample loops read, so knob moves
+    // and morph sweeps glide instead of stepping at block boundaries
+    Fade delayRamp;
+    Fade feedbackRamp;
+    Fade mixRamp;
+
+    // 0 plays the live delay chain, 1 the frozen loop
+    Fade freezeFade;
+
+    // Follows the shimmer amount; the grains only run while it is above zero
+    Fade shimmerRamp;
+
+    // 0 passes the dry signal straight through, 1 holds it back by the spectral latency
+    Fade dryLatencyFade;
+    juce::AudioBuffer<SampleType> wetBuffer;
+    juce::AudioBuffer<SampleType> stageScratchBuffer;
+
+    StageProfiler *profiler = nullptr;
+    ScopeFifo *scope = nullptr;
+
+    double sampleRate;
+    SampleType chorusRate;
+    SampleType chorusDepth;
+    SampleType chorusPhase;
+    SampleType chorusPhaseIncrement;
+};
@@ -1,33 +1,286 @@
 #include "DelayManager.h"
 
-DelayManager::DelayManager()
+template <typename SampleType>
+DelayManager<SampleType>::DelayManager()
     : lastKnownBPM(120.0f), sampleRate(44100.0f)
 {
 }
 
-void DelayManager::prepare(const juce::dsp::ProcessSpec &spec)
+template <typename SampleType>
+void DelayManager<SampleType>::prepare(const juce::dsp::ProcessSpec &spec)
 {
     sampleRate = static_cast<float>(spec.sampleRate);
-    delayLine.prepare(spec);
-    delayLine.setMaximumDelayInSamples(static_cast<int>(sampleRate * 5.0)); // 5 seconds maximum delay
+    maximumDelay = static_cast<int>(sampleRate * 5.0); // 5 seconds maximum delay
+
+    // Room for the three extra taps the Lagrange read needs beyond the maximum delay
+    bufferSize = maximumDelay + 4;
+    auto numChannels = static_cast<int>(spec.numChannels);
+    buffer.setSize(numChannels, bufferSize);
+    writePositions.assign(static_cast<size_t>(numChannels), 0);
+    jumpHeads.assign(static_cast<size_t>(numChannels), JumpHeads());
+    reverseHeads.assign(static_cast<size_t>(numChannels), {});
+    frozenLoops.assign(static_cast<size_t>(numChannels), FrozenLoop());
+
+    // 20 ms equal-power crossfade between the old and new read positions
+    jumpFadeLength = juce::jmax(1, static_cast<int>(sampleRate * 0.02f));
+    jumpFadeGains.resize(static_cast<size_t>(jumpFadeLength + 1));
+    for (int i = 0; i <= jumpFadeLength; ++i)
+        jumpFadeGains[static_cast<size_t>(i)] = static_cast<SampleType>(std::sin(juce::MathConstants<double>::halfPi * i / jumpFadeLength));
+
+    reset();
+}
+
+template <typename SampleType>
+void DelayManager<SampleType>::reset()
+{
+    buffer.clear();
+    std::fill(writePositions.begin(), writePositions.end(), 0);
+
+    for (auto &heads : jumpHeads)
+    {
+        heads.currentDelay = juce::jlimit(0, maximumDelay, juce::roundToInt(delay));
+        heads.previousDelay = heads.currentDelay;
+        heads.fadeSamplesRemaining = 0;
+    }
+
+    std::fill(frozenLoops.begin(), frozenLoops.end(), FrozenLoop());
+}
+
+template <typename SampleType>
+void DelayManager<SampleType>::setDelay(SampleType delayInSamples)
+{
+    delay = juce::jlimit(SampleType(0), static_cast<SampleType>(maximumDelay), delayInSamples);
+
+    // Jump heads start settled on the new delay rather than fading in from zero
+    for (auto &heads : jumpHeads)
+    {
+        heads.currentDelay = juce::roundToInt(delay);
+        heads.previousDelay = heads.currentDelay;
+        heads.fadeSamplesRemaining = 0;
+    }
+}
+
+template <typename SampleType>
+SampleType DelayManager<SampleType>::readSample(int channel, int samplesAgo) const
+{
+    int index = writePositions[static_cast<size_t>(channel)] - samplesAgo;
+    if (index < 0)
+        index += bufferSize;
+
+    return buffer.getSample(channel, index);
+}
+
+template <typename SampleType>
+SampleType DelayManager<SampleType>::readInterpolated(int channel, SampleType samplesAgo) const
+{
+    // The slot at zero samples ago is the next one written, so the newest readable sample is one ago
+    SampleType clamped = juce::jlimit(SampleType(1), static_cast<SampleType>(maximumDelay), samplesAgo);
+    int whole = static_cast<int>(clamped);
+    SampleType fraction = clamped - static_cast<SampleType>(whole);
+
+    auto newer = readSample(channel, whole);
+    auto older = readSample(channel, whole + 1);
+    return newer + fraction * (older - newer);
+}
+
+template <typename SampleType>
+SampleType DelayManager<SampleType>::popSample(int channel, SampleType delayInSamples)
+{
+    SampleType clampedDelay = juce::jlimit(SampleType(0), static_cast<SampleType>(maximumDelay), delayInSamples);
+    int delayInt = static_cast<int>(std::floor(clampedDelay));
+    SampleType delayFrac = clampedDelay - static_cast<SampleType>(delayInt);
+
+    // Centre the four taps around the read position where there is history to do so
+    if (delayInt >= 1)
+    {
+        delayFrac += SampleType(1);
+        --delayInt;
+    }
+
+    auto value1 = readSample(channel, delayInt);
+    auto value2 = readSample(channel, delayInt + 1);
+    auto value3 = readSample(channel, delayInt + 2);
+    auto value4 = readSample(channel, delayInt + 3);
+
+    auto d1 = delayFrac - SampleType(1);
+    auto d2 = delayFrac - SampleType(2);
+    auto d3 = delayFrac - SampleType(3);
+
+    auto c1 = -d1 * d2 * d3 / SampleType(6);
+    auto c2 = d2 * d3 * SampleType(0.5);
+    auto c3 = -d1 * d3 * SampleType(0.5);
+    auto c4 = d1 * d2 / SampleType(6);
+
+    return value1 * c1 + delayFrac * (value2 * c2 + value3 * c3 + value4 * c4);
 }
 
-void DelayManager::setDelay(float delayInSamples)
+template <typename SampleType>
+SampleType DelayManager<SampleType>::popSampleJump(int channel, SampleType delayInSamples)
 {
-    delayLine.setDelay(delayInSamples);
+    auto &heads = jumpHeads[static_cast<size_t>(channel)];
+
+    if (heads.fadeSamplesRemaining == 0)
+    {
+        int requestedDelay = juce::jlimit(0, maximumDelay, juce::roundToInt(delayInSamples));
+
+        // Steady state: a single integer read
+        if (requestedDelay == heads.currentDelay)
+            return readSample(channel, heads.currentDelay);
+
+        heads.previousDelay = heads.currentDelay;
+        heads.currentDelay = requestedDelay;
+        heads.fadeSamplesRemaining = jumpFadeLength;
+    }
+
+    // Runs 1..jumpFadeLength so the last faded sample already matches the steady state
+    int position = jumpFadeLength - heads.fadeSamplesRemaining + 1;
+    --heads.fadeSamplesRemaining;
+
+    auto fadeIn = jumpFadeGains[static_cast<size_t>(position)];
+    auto fadeOut = jumpFadeGains[static_cast<size_t>(jumpFadeLength - position)];
+
+    return fadeIn * readSample(channel, heads.currentDelay) + fadeOut * readSample(channel, heads.previousDelay);
 }
 
-float DelayManager::popSample(int channel, float delayInSamples)
+template <typename SampleType>
+int DelayManager<SampleType>::clampSegment(SampleType segmentInSamples) const
 {
-    return delayLine.popSample(channel, delayInSamples);
+    // A head reads back twice its segment length, and the writes must not catch it
+    return juce::jlimit(2, maximumDelay / 2, juce::roundToInt(segmentInSamples));
 }
 
-void DelayManager::pushSample(int channel, float sample)
+template <typename SampleType>
+void DelayManager<SampleType>::startReverseHead(ReverseHead &head, int channel, int length, int samplesIn) const
 {
-    delayLine.pushSample(channel, sample);
+    // A head samplesIn into its segment started that many samples ago and has stepped down as many since
+    int readIndex = writePositions[static_cast<size_t>(channel)] - 1 - 2 * samplesIn;
+    while (readIndex < 0)
+        readIndex += bufferSize;
+
+    head.readIndex = readIndex;
+    head.phase = samplesIn;
+    head.length = length;
 }
 
-float DelayManager::updateDelayTimeFromSync(float bpm, int syncMode)
+template <typename SampleType>
+void DelayManager<SampleType>::startReverse(SampleType segmentInSamples)
+{
+    int segment = clampSegment(segmentInSamples);
+
+    for (size_t channel = 0; channel < reverseHeads.size(); ++channel)
+    {
+        auto &heads = reverseHeads[channel];
+        startReverseHead(heads[0], static_cast<int>(channel), segment, 0);
+        startReverseHead(heads[1], static_cast<int>(channel), segment, segment / 2);
+    }
+}
+
+template <typename SampleType>
+SampleType DelayManager<SampleType>::popSampleReverse(int channel, SampleType segmentInSamples)
+{
+    auto &heads = reverseHeads[static_cast<size_t>(channel)];
+    auto &main = heads[0];
+    auto &offset = heads[1];
+
+    // New delay times take effect as the main head starts a segment. The offset head sizes its segment so its
+    // peak lands on the main head's boundary, which pulls the pair back half a segment apart after a change.
+    if (main.phase >= main.length)
+        startReverseHead(main, channel, clampSegment(segmentInSamples), 0);
+    if (offset.phase >= offset.length)
+        startReverseHead(offset, channel, clampSegment(static_cast<SampleType>(2 * (main.length - main.phase))), 0);
+
+    auto *data = buffer.getReadPointer(channel);
+    SampleType output = 0;
+
+    for (auto &head : heads)
+    {
+        auto window = SampleType(1) - static_cast<SampleType>(std::abs(2 * head.phase - head.length)) / static_cast<SampleType>(head.length);
+        output += window * data[head.readIndex];
+
+        if (--head.readIndex < 0)
+            head.readIndex += bufferSize;
+        ++head.phase;
+    }
+
+    return output;
+}
+
+template <typename SampleType>
+void DelayManager<SampleType>::captureFreezeLoop(SampleType loopLengthInSamples)
+{
+    // Leave room behind the loop for the seam pre-roll plus the writes made while fading in and out
+    freezeLoopLength = juce::jlimit(2, maximumDelay - 3 * jumpFadeLength, juce::roundToInt(loopLengthInSamples));
+    freezeSeamLength = juce::jmax(1, juce::jmin(jumpFadeLength, freezeLoopLength / 2));
+
+    for (size_t channel = 0; channel < frozenLoops.size(); ++channel)
+    {
+        int start = writePositions[channel] - freezeLoopLength;
+        if (start < 0)
+            start += bufferSize;
+
+        frozenLoops[channel].start = start;
+        frozenLoops[channel].phase = 0;
+        frozenLoops[channel].writesLeft = bufferSize - freezeLoopLength - freezeSeamLength;
+    }
+}
+
+template <typename SampleType>
+bool DelayManager<SampleType>::canResumeFreezeLoop() const
+{
+    for (const auto &loop : frozenLoops)
+        if (loop.writesLeft < 2 * jumpFadeLength)
+            return false;
+    return true;
+}
+
+template <typename SampleType>
+SampleType DelayManager<SampleType>::popFrozenSample(int channel)
+{
+    auto &loop = frozenLoops[static_cast<size_t>(channel)];
+
+    int index = loop.start + loop.phase;
+    if (index >= bufferSize)
+        index -= bufferSize;
+
+    auto output = buffer.getSample(channel, index);
+
+    // Over the last freezeSeamLength samples the loop end hands over to the samples just before its
+    // start, so the wrap back to phase 0 continues from exactly where the pre-roll left off
+    int seamStart = freezeLoopLength - freezeSeamLength;
+    if (loop.phase >= seamStart)
+    {
+        int preRollIndex = index - freezeLoopLength;
+        if (preRollIndex < 0)
+            preRollIndex += bufferSize;
+
+        int position = (loop.phase - seamStart + 1) * jumpFadeLength / freezeSeamLength;
+        output = output * jumpFadeGains[static_cast<size_t>(jumpFadeLength - position)] +
+                 buffer.getSample(channel, preRollIndex) * jumpFadeGains[static_cast<size_t>(position)];
+    }
+
+    if (++loop.phase == freezeLoopLength)
+        loop.phase = 0;
+
+    return output;
+}
+
+template <typename SampleType>
+void DelayManager<SampleType>::pushSample(int channel, SampleType sample)
+{
+    auto &writePosition = writePositions[static_cast<size_t>(channel)];
+    buffer.setSample(channel, writePosition, sample);
+
+    if (++writePosition == bufferSize)
+        writePosition = 0;
+
+    // Counts down towards the frozen loop's pre-roll; stops at zero so it never wraps
+    auto &loop = frozenLoops[static_cast<size_t>(channel)];
+    if (loop.writesLeft > 0)
+        --loop.writesLeft;
+}
+
+template <typename SampleType>
+float DelayManager<SampleType>::updateDelayTimeFromSync(float bpm, int syncMode)
 {
     lastKnownBPM = bpm;
     double beatsPerSecond = bpm / 60.0;
@@ -98,7 +351,11 @@ float DelayManager::updateDelayTimeFromSync(float bpm, int syncMode)
     return juce::jlimit(0.0f, maxDelayTime, delayTime);
 }
 
-float DelayManager::getMaximumDelayInSeconds() const
+template <typename SampleType>
+float DelayManager<SampleType>::getMaximumDelayInSeconds() const
 {
-    return static_cast<float>(delayLine.getMaximumDelayInSamples()) / sampleRate;
-}
\ No newline at end of file
+    return static_cast<float>(maximumDelay) / sampleRate;
+}
+
+template class DelayManager<float>;
+template class DelayManager<double>;
\ No newline at end of file
@@ -1,21 +1,88 @@
 #pragma once
 
 #include <juce_dsp/juce_dsp.h>
+#include <array>
+#include <vector>
 
+template <typename SampleType>
 class DelayManager
 {
 public:
     DelayManager();
     void prepare(const juce::dsp::ProcessSpec &spec);
-    void setDelay(float delayInSamples);
-    float getDelay() const { return delayLine.getDelay(); }
-    float popSample(int channel, float delayInSamples);
-    void pushSample(int channel, float sample);
+    void reset();
+    void setDelay(SampleType delayInSamples);
+    SampleType getDelay() const { return delay; }
+
+    // Glide: fractional read with third-order Lagrange interpolation, so delay changes sweep the read position
+    SampleType popSample(int channel, SampleType delayInSamples);
+
+    // Jump: integer read from one head. When the rounded delay changes, a second head at the new
+    // position is brought in with a short equal-power crossfade; a change requested mid-fade waits for it to end.
+    SampleType popSampleJump(int channel, SampleType delayInSamples);
+
+    void pushSample(int channel, SampleType sample);
+
+    // Linear read for secondary taps such as grains, clamped to the buffer's history
+    SampleType readInterpolated(int channel, SampleType samplesAgo) const;
+
+    // Reverse: plays the buffer backwards in segments of segmentInSamples (at most half the maximum delay).
+    // Two heads with triangular windows sit half a segment apart, so one is always crossing over while the
+    // other is at full level; both step down through memory one sample at a time.
+    void startReverse(SampleType segmentInSamples);
+    SampleType popSampleReverse(int channel, SampleType segmentInSamples);
+
+    // Freeze: captures the last loopLengthInSamples written as a loop. popFrozenSample plays it back with the
+    // wrap crossfaded against the audio that preceded the loop, and nothing needs pushing while it plays.
+    // The loop stays intact for at least a further 2 * jumpFadeLength writes, enough to fade the live path in and out.
+    void captureFreezeLoop(SampleType loopLengthInSamples);
+    SampleType popFrozenSample(int channel);
+
+    // Whether the captured loop still has room behind it for another fade in and out of live writes;
+    // once it doesn't, re-engaging freeze has to capture a new loop
+    bool canResumeFreezeLoop() const;
+
     float updateDelayTimeFromSync(float bpm, int syncMode);
     float getMaximumDelayInSeconds() const;
 
 private:
-    juce::dsp::DelayLine<float, juce::dsp::DelayLineInterpolationTypes::Lagrange3rd> delayLine;
+    struct JumpHeads
+    {
+        int currentDelay = 0;
+        int previousDelay = 0;
+        int fadeSamplesRemaining = 0;
+    };
+
+    struct ReverseHead
+    {
+        int readIndex = 0;
+        int phase = 0;
+        int length = 0;
+    };
+
+    struct FrozenLoop
+    {
+        int start = 0;
+        int phase = 0;
+        int writesLeft = 0; // pushes before the writes reach the seam pre-roll
+    };
+
+    SampleType readSample(int channel, int samplesAgo) const;
+    int clampSegment(SampleType segmentInSamples) const;
+    void startReverseHead(ReverseHead &head, int channel, int length, int samplesIn) const;
+
+    juce::AudioBuffer<SampleType> buffer;
+    std::vector<int> writePositions;
+    std::vector<JumpHeads> jumpHeads;
+    std::vector<SampleType> jumpFadeGains; // sin over a quarter period, jumpFadeLength + 1 entries
+    std::vector<std::array<ReverseHead, 2>> reverseHeads;
+    std::vector<FrozenLoop> frozenLoops;
+    int freezeLoopLength = 1;
+    int freezeSeamLength = 1;
+    int bufferSize = 0;
+    int maximumDelay = 0;
+    int jumpFadeLength = 0;
+    SampleType delay = 0;
     float lastKnownBPM;
     float sampleRate;
-};
\ No newline at end of file
+};
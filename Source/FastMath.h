@@ -0,0 +1,121 @@
+#pragma once
+
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+// Branch-free approximations for the audio-rate and per-sub-block modulation paths. Plain
+// arithmetic, selects and integer conversions only, so loops calling them can vectorise.
+// The coefficients target float precision; the double engine runs the same approximations.
+// Building with AUDIODELAY_LIBM_MATH=1 swaps every function for the C library one, for reference renders.
+//
+// Maximum error against double-precision libm, double / float instantiation:
+//   exp2  relative 1.7e-7 / 2.4e-7 for x in [-126, 126], clamped outside it
+//   sin   absolute 5.7e-8 / 6.4e-7 for |x| <= 8; float range reduction degrades beyond that
+//   cos   absolute 5.7e-8 / 1.1e-6 for |x| <= 8
+//   tan   relative 5.7e-8 / 4.4e-6 for |x| <= 1.5
+//   tanh  absolute 7.9e-8 / 2.1e-7 everywhere, exactly +-1 for large |x|
+namespace FastMath
+{
+#if AUDIODELAY_LIBM_MATH
+    static constexpr const char *name = "libm";
+
+    template <typename T> T exp2(T x) { return std::exp2(x); }
+    template <typename T> T sin(T x) { return std::sin(x); }
+    template <typename T> T cos(T x) { return std::cos(x); }
+    template <typename T> T tan(T x) { return std::tan(x); }
+    template <typename T> T tanh(T x) { return std::tanh(x); }
+    template <typename T> T round(T x) { return std::round(x); }
+#else
+    static constexpr const char *name = "fast approximations";
+
+    // floor(x + 0.5) through a truncating conversion, which SSE2 and NEON both vectorise;
+    // exact halves round up rather than away from zero. Valid for |x| < 2^31.
+    template <typename T>
+    T round(T x)
+    {
+        T shifted = x + T(0.5);
+        T truncated = static_cast<T>(static_cast<int32_t>(shifted));
+        return truncated - (truncated > shifted ? T(1) : T(0));
+    }
+
+    template <typename T>
+    T exp2(T x)
+    {
+        static_assert(std::is_floating_point<T>::value, "FastMath works on float and double");
+
+        x = x < T(-126) ? T(-126) : (x > T(126) ? T(126) : x);
+
+        // 2^x = 2^i * 2^g with g in [-0.5, 0.5]; Taylor to g^6 is good to 1.3e-7 there
+        T whole = round(x);
+        T g = x - whole;
+        T p = T(1.5403530393381606e-4);
+        p = p * g + T(1.3333558146428443e-3);
+        p = p * g + T(9.6181291076284772e-3);
+        p = p * g + T(5.5504108664821580e-2);
+        p = p * g + T(2.4022650695910071e-1);
+        p = p * g + T(6.9314718055994531e-1);
+        p = p * g + T(1);
+
+        // Scale by 2^whole straight into the exponent bits
+        auto exponent = static_cast<int32_t>(whole);
+        if constexpr (std::is_same<T, float>::value)
+        {
+            uint32_t bits = static_cast<uint32_t>(exponent + 127) << 23;
+            float scale;
+            std::memcpy(&scale, &bits, sizeof(scale));
+            return p * scale;
+        }
+        else
+        {
+            uint64_t bits = static_cast<uint64_t>(exponent + 1023) << 52;
+            double scale;
+            std::memcpy(&scale, &bits, sizeof(scale));
+            return p * scale;
+        }
+    }
+
+    template <typename T>
+    T sin(T x)
+    {
+        // Reduce to turns in [-0.5, 0.5], then fold onto a quarter turn: sin(2pi t) = sign(t) sin(2pi min(|t|, 0.5 - |t|))
+        T turns = x * T(0.15915494309189535);
+        turns -= round(turns);
+        T magnitude = turns < T(0) ? -turns : turns;
+        T folded = magnitude < T(0.5) - magnitude ? magnitude : T(0.5) - magnitude;
+
+        // Taylor to r^11 on [0, pi/2]: truncation error below 5.7e-8
+        T r = folded * T(6.283185307179586);
+        T r2 = r * r;
+        T p = T(-2.5052108385441720e-8);
+        p = p * r2 + T(2.7557319223985893e-6);
+        p = p * r2 + T(-1.9841269841269841e-4);
+        p = p * r2 + T(8.3333333333333333e-3);
+        p = p * r2 + T(-1.6666666666666667e-1);
+        p = p * r2 + T(1);
+        T result = p * r;
+
+        return turns < T(0) ? -result : result;
+    }
+
+    template <typename T>
+    T cos(T x)
+    {
+        return sin(x + T(1.5707963267948966));
+    }
+
+    template <typename T>
+    T tan(T x)
+    {
+        return sin(x) / cos(x);
+    }
+
+    template <typename T>
+    T tanh(T x)
+    {
+        // tanh(x) = 1 - 2 / (e^2x + 1); exp2 clamps, so large inputs settle on +-1 without overflow
+        return T(1) - T(2) / (exp2(x * T(2.8853900817779268)) + T(1));
+    }
+#endif
+}
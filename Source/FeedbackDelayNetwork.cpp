@@ -0,0 +1,190 @@
+#include "FeedbackDelayNetwork.h"
+
+template <typename SampleType>
+void FeedbackDelayNetwork<SampleType>::prepare(const juce::dsp::ProcessSpec &spec, double maximumDelaySeconds)
+{
+    bufferLength = juce::jmax(MAX_LINES, static_cast<int>(spec.sampleRate * maximumDelaySeconds) + 1);
+
+    channels.resize(spec.numChannels);
+    for (auto &state : channels)
+        state.rings.assign(static_cast<size_t>(bufferLength) * MAX_LINES, SampleType(0));
+
+    fadeLength = juce::jmax(1, static_cast<int>(spec.sampleRate * 0.02));
+    fadeGains.resize(static_cast<size_t>(fadeLength + 1));
+    for (int i = 0; i <= fadeLength; ++i)
+        fadeGains[static_cast<size_t>(i)] = static_cast<SampleType>(std::sin(juce::MathConstants<double>::halfPi * i / fadeLength));
+
+    reset();
+}
+
+template <typename SampleType>
+void FeedbackDelayNetwork<SampleType>::reset()
+{
+    for (auto &state : channels)
+    {
+        std::fill(state.rings.begin(), state.rings.end(), SampleType(0));
+        state.feedbackFrame.fill(SampleType(0));
+        state.writeIndex = 0;
+
+        // Nothing to fade from in a cleared network
+        state.delay = -1;
+        state.fadeSamplesRemaining = 0;
+    }
+}
+
+template <typename SampleType>
+void FeedbackDelayNetwork<SampleType>::setNumLines(int newNumLines)
+{
+    newNumLines = newNumLines >= 16 ? 16 : (newNumLines >= 8 ? 8 : 4);
+    if (newNumLines == numLines)
+        return;
+
+    numLines = newNumLines;
+    reset();
+}
+
+template <typename SampleType>
+bool FeedbackDelayNetwork<SampleType>::isPrime(int value)
+{
+    if (value < 2)
+        return false;
+    if (value % 2 == 0)
+        return value == 2;
+
+    for (int divisor = 3; divisor * divisor <= value; divisor += 2)
+        if (value % divisor == 0)
+            return false;
+
+    return true;
+}
+
+template <typename SampleType>
+void FeedbackDelayNetwork<SampleType>::setDelayAndFeedback(SampleType delayInSamples, SampleType feedback)
+{
+    // The lengths themselves move in popSample, where each channel can start its crossfade
+    targetDelay = juce::jlimit(MAX_LINES * 4, bufferLength - 1, juce::roundToInt(delayInSamples));
+
+    if (feedback != currentFeedback)
+    {
+        currentFeedback = feedback;
+        for (auto &state : channels)
+            updateGains(state);
+    }
+}
+
+template <typename SampleType>
+void FeedbackDelayNetwork<SampleType>::retune(size_t channel)
+{
+    auto &state = channels[channel];
+    state.previousLengths = state.lengths;
+    state.fadeSamplesRemaining = state.delay < 0 ? 0 : fadeLength;
+    state.delay = targetDelay;
+
+    // Geometric spread from half the delay up to the delay, each nudged up to the next unused prime.
+    // The second channel starts its search a little higher so the two networks decorrelate.
+    int previous = 0;
+    for (int i = 0; i < numLines; ++i)
+    {
+        double ratio = std::pow(2.0, static_cast<double>(i + 1 - numLines) / numLines);
+        int candidate = juce::jmax(previous + 1, static_cast<int>(state.delay * ratio) + static_cast<int>(channel) * 7);
+
+        while (!isPrime(candidate) && candidate < bufferLength - 1)
+            ++candidate;
+
+        state.lengths[static_cast<size_t>(i)] = juce::jmin(candidate, bufferLength - 1);
+        previous = state.lengths[static_cast<size_t>(i)];
+    }
+
+    updateGains(state);
+}
+
+template <typename SampleType>
+void FeedbackDelayNetwork<SampleType>::updateGains(ChannelState &state)
+{
+    if (state.delay < 0)
+        return;
+
+    // Scale each line's gain by its length so every path decays at the same rate per second
+    for (size_t i = 0; i < static_cast<size_t>(numLines); ++i)
+        state.lineGains[i] = std::pow(currentFeedback, static_cast<SampleType>(state.lengths[i]) / static_cast<SampleType>(state.delay));
+}
+
+template <typename SampleType>
+SampleType FeedbackDelayNetwork<SampleType>::readLine(const ChannelState &state, int line, int length) const
+{
+    int readIndex = state.writeIndex - length;
+    if (readIndex < 0)
+        readIndex += bufferLength;
+    return state.rings[static_cast<size_t>(line) * static_cast<size_t>(bufferLength) + static_cast<size_t>(readIndex)];
+}
+
+template <typename SampleType>
+template <int N>
+SampleType FeedbackDelayNetwork<SampleType>::popFrame(int channel)
+{
+    auto &state = channels[static_cast<size_t>(channel)];
+    alignas(32) std::array<SampleType, N> lines;
+
+    if (state.fadeSamplesRemaining > 0)
+    {
+        // Runs 1..fadeLength so the last faded sample already matches the steady state
+        int position = fadeLength - state.fadeSamplesRemaining + 1;
+        --state.fadeSamplesRemaining;
+
+        auto fadeIn = fadeGains[static_cast<size_t>(position)];
+        auto fadeOut = fadeGains[static_cast<size_t>(fadeLength - position)];
+        for (int i = 0; i < N; ++i)
+            lines[static_cast<size_t>(i)] = fadeIn * readLine(state, i, state.lengths[static_cast<size_t>(i)]) +
+                                            fadeOut * readLine(state, i, state.previousLengths[static_cast<size_t>(i)]);
+    }
+    else
+    {
+        for (int i = 0; i < N; ++i)
+            lines[static_cast<size_t>(i)] = readLine(state, i, state.lengths[static_cast<size_t>(i)]);
+    }
+
+    // Output tap and Hadamard mix into the next feedback frame
+    NetworkFrame<SampleType> frame;
+    frame.lines = lines.data();
+    frame.lineGains = state.lineGains.data();
+    frame.feedback = state.feedbackFrame.data();
+    frame.normalise = SampleType(1) / std::sqrt(static_cast<SampleType>(N));
+    frame.numLines = N;
+    return mixKernel(frame);
+}
+
+template <typename SampleType>
+SampleType FeedbackDelayNetwork<SampleType>::popSample(int channel)
+{
+    const auto index = static_cast<size_t>(channel);
+    if (channels[index].fadeSamplesRemaining == 0 && channels[index].delay != targetDelay)
+        retune(index);
+
+    switch (numLines)
+    {
+    case 16:
+        return popFrame<16>(channel);
+    case 8:
+        return popFrame<8>(channel);
+    default:
+        return popFrame<4>(channel);
+    }
+}
+
+template <typename SampleType>
+void FeedbackDelayNetwork<SampleType>::pushSample(int channel, SampleType input)
+{
+    auto &state = channels[static_cast<size_t>(channel)];
+    auto *write = state.rings.data() + state.writeIndex;
+
+    // Input goes into every line with alternating sign, scaled to keep the total energy at unity
+    const SampleType inputGain = input / std::sqrt(static_cast<SampleType>(numLines));
+    for (int i = 0; i < numLines; ++i)
+        write[static_cast<size_t>(i) * static_cast<size_t>(bufferLength)] = state.feedbackFrame[static_cast<size_t>(i)] + ((i & 1) ? -inputGain : inputGain);
+
+    if (++state.writeIndex == bufferLength)
+        state.writeIndex = 0;
+}
+
+template class FeedbackDelayNetwork<float>;
+template class FeedbackDelayNetwork<double>;
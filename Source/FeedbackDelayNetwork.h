@@ -0,0 +1,69 @@
+#pragma once
+
+#include <juce_dsp/juce_dsp.h>
+#include <array>
+#include <vector>
+#include "DSPKernels.h"
+
+// Per-channel feedback delay network with 4, 8 or 16 lines. Line lengths are distinct primes spread
+// below the delay time, so they are mutually prime, and the lines are mixed through a normalised
+// Hadamard matrix applied as a fast Walsh-Hadamard transform (N log N adds, no multiplies).
+// Each line has its own ring, one after another in a per-channel block, so every line's reads and
+// writes walk forward through memory a sample at a time.
+// A new delay crossfades every line from its old length to its new one over 20 ms, the same
+// equal-power fade DelayManager's jump mode uses, so moving the delay doesn't click.
+template <typename SampleType>
+class FeedbackDelayNetwork
+{
+public:
+    static const int MAX_LINES = 16;
+
+    void prepare(const juce::dsp::ProcessSpec &spec, double maximumDelaySeconds);
+    void reset();
+
+    // 4, 8 or 16; changing it clears the network
+    void setNumLines(int newNumLines);
+    int getNumLines() const { return numLines; }
+
+    // Line lengths follow the rounded delay; a change requested mid-crossfade waits for it to end
+    void setDelayAndFeedback(SampleType delayInSamples, SampleType feedback);
+
+    // The Hadamard mix runs through the engine's dispatched kernel; set before processing
+    void setMixKernel(SampleType (*kernel)(NetworkFrame<SampleType> &)) { mixKernel = kernel; }
+
+    // Reads and mixes the lines for this sample, returning the output tap
+    SampleType popSample(int channel);
+
+    // Writes the mixed feedback plus the new input; must follow popSample for the same channel
+    void pushSample(int channel, SampleType input);
+
+private:
+    template <int N>
+    SampleType popFrame(int channel);
+
+    struct ChannelState
+    {
+        std::vector<SampleType> rings; // MAX_LINES rings of bufferLength samples
+        int writeIndex = 0;            // shared by every ring
+        int delay = -1; // what lengths were made for; -1 takes the next delay without a crossfade
+        int fadeSamplesRemaining = 0;
+        std::array<int, MAX_LINES> lengths{};
+        std::array<int, MAX_LINES> previousLengths{}; // faded out while fadeSamplesRemaining > 0
+        std::array<SampleType, MAX_LINES> lineGains{};
+        alignas(32) std::array<SampleType, MAX_LINES> feedbackFrame{};
+    };
+
+    void retune(size_t channel);
+    void updateGains(ChannelState &state);
+    SampleType readLine(const ChannelState &state, int line, int length) const;
+    static bool isPrime(int value);
+
+    std::vector<ChannelState> channels;
+    std::vector<SampleType> fadeGains; // sin over a quarter period, fadeLength + 1 entries
+    int fadeLength = 1;
+    int numLines = 4;
+    int bufferLength = 0;
+    int targetDelay = MAX_LINES * 4;
+    SampleType currentFeedback = 0;
+    SampleType (*mixKernel)(NetworkFrame<SampleType> &) = nullptr;
+};
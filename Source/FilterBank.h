@@ -0,0 +1,243 @@
+#pragma once
+
+#include <juce_dsp/juce_dsp.h>
+#include <array>
+#include "FastMath.h"
+#include "DSPKernels.h"
+
+// Coefficients and per-channel state of every recursive filter the delay loop runs, kept in one
+// cache-line-aligned block instead of a dozen separately allocated JUCE filter objects. Fields are
+// arrays over filters and channels (structure of arrays), so both channels of a stage share a line
+// and the whole set is a few lines that only the audio thread ever writes.
+//
+// The filters match the JUCE ones they replace: the state variable filters are the same TPT
+// structure as juce::dsp::StateVariableTPTFilter, the biquads are transposed direct form II with
+// IIR::ArrayCoefficients designs, as in juce::dsp::IIR::Filter. The wet highpass and lowpass are
+// cascades of up to four such biquads, run by the dispatched kernel with both channels in the two
+// lanes of one register. Cascade coefficients and state are double whatever SampleType is: at the
+// 5 Hz output DC cutoff a float recursion strays about -40 dB from the exact response.
+template <typename SampleType>
+struct alignas(64) FilterBank
+{
+    static const int NUM_CHANNELS = 2;
+
+    enum StateVariable
+    {
+        PreDiffusionLowpass,
+        Diffusion1, // bandpass
+        Diffusion2,
+        Diffusion3,
+        Diffusion4,
+        PostDiffusionLowpass,
+        NumStateVariables
+    };
+
+    enum Biquad
+    {
+        DCBlocker,     // 20 Hz highpass in the feedback loop
+        ChorusLowpass, // one state shared by both channels, as the mono filter it replaces was
+        NumBiquads
+    };
+
+    // Wet highpass and lowpass: Butterworth of order 2, 4, 6 or 8 (12 to 48 dB/oct), one biquad per 12 dB
+    enum Cascade
+    {
+        HighpassCascade,
+        LowpassCascade,
+        OutputDCCascade, // 5 Hz highpass on the mixed output, always one section
+        NumCascades
+    };
+
+    static const int MAX_CASCADE_SECTIONS = 4;
+
+    // g, R2 and h of the TPT design; the default resonance is StateVariableTPTFilter's
+    void setStateVariable(int filter, double sampleRate, SampleType cutoff, SampleType resonance = SampleType(1) / juce::MathConstants<SampleType>::sqrt2)
+    {
+        svfR2[filter] = SampleType(1) / resonance;
+        setCutoff(filter, sampleRate, cutoff);
+    }
+
+    // Keeps the resonance; cutoffs move every sub-block, so tan is the fast one (cutoff / sampleRate stays under 0.46)
+    void setCutoff(int filter, double sampleRate, SampleType cutoff)
+    {
+        SampleType g = FastMath::tan(juce::MathConstants<SampleType>::pi * cutoff / static_cast<SampleType>(sampleRate));
+        svfG[filter] = g;
+        svfH[filter] = SampleType(1) / (SampleType(1) + svfR2[filter] * g + g * g);
+    }
+
+    // Takes the {b0, b1, b2, a0, a1, a2} layout of IIR::ArrayCoefficients and normalises by a0
+    void setBiquad(int filter, const std::array<SampleType, 6> &design)
+    {
+        SampleType a0 = design[3];
+        auto *c = biquadCoefficients[filter];
+        c[0] = design[0] / a0;
+        c[1] = design[1] / a0;
+        c[2] = design[2] / a0;
+        c[3] = design[4] / a0;
+        c[4] = design[5] / a0;
+    }
+
+    // Every section at the same cutoff, with the Qs that make the product Butterworth. Sections
+    // switched in by a steeper slope start from silence.
+    void setCascade(int cascade, bool highpass, double sampleRate, SampleType cutoff, int numSections)
+    {
+        static const SampleType butterworthQ[MAX_CASCADE_SECTIONS][MAX_CASCADE_SECTIONS] = {
+            {SampleType(0.70710678), 0, 0, 0},
+            {SampleType(0.54119610), SampleType(1.30656296), 0, 0},
+            {SampleType(0.51763809), SampleType(0.70710678), SampleType(1.93185165), 0},
+            {SampleType(0.50979558), SampleType(0.60134489), SampleType(0.89997622), SampleType(2.56291545)}};
+
+        numSections = juce::jlimit(1, static_cast<int>(MAX_CASCADE_SECTIONS), numSections);
+        for (int section = cascadeSections[cascade]; section < numSections; ++section)
+            for (int channel = 0; channel < NUM_CHANNELS; ++channel)
+                cascadeState1[cascade][section][channel] = cascadeState2[cascade][section][channel] = 0.0;
+        cascadeSections[cascade] = numSections;
+
+        for (int section = 0; section < numSections; ++section)
+        {
+            auto q = static_cast<double>(butterworthQ[numSections - 1][section]);
+            auto frequency = static_cast<double>(cutoff);
+            auto design = highpass ? juce::dsp::IIR::ArrayCoefficients<double>::makeHighPass(sampleRate, frequency, q)
+                                   : juce::dsp::IIR::ArrayCoefficients<double>::makeLowPass(sampleRate, frequency, q);
+
+            double a0 = design[3];
+            cascadeB0[cascade][section] = design[0] / a0;
+            cascadeB1[cascade][section] = design[1] / a0;
+            cascadeB2[cascade][section] = design[2] / a0;
+            cascadeA1[cascade][section] = design[4] / a0;
+            cascadeA2[cascade][section] = design[5] / a0;
+        }
+    }
+
+    // Runs the whole cascade over a sub-block in place through the dispatched kernel; right is null for mono
+    void processCascade(int cascade, SampleType *left, SampleType *right, int numSamples)
+    {
+        CascadeBlock<SampleType> block;
+        block.left = left;
+        block.right = right;
+        block.b0 = cascadeB0[cascade];
+        block.b1 = cascadeB1[cascade];
+        block.b2 = cascadeB2[cascade];
+        block.a1 = cascadeA1[cascade];
+        block.a2 = cascadeA2[cascade];
+        block.state1 = cascadeState1[cascade][0];
+        block.state2 = cascadeState2[cascade][0];
+        block.numSections = cascadeSections[cascade];
+        block.numSamples = numSamples;
+        cascadeKernel(block);
+
+        for (int section = 0; section < cascadeSections[cascade]; ++section)
+        {
+            for (int channel = 0; channel < NUM_CHANNELS; ++channel)
+            {
+                juce::dsp::util::snapToZero(cascadeState1[cascade][section][channel]);
+                juce::dsp::util::snapToZero(cascadeState2[cascade][section][channel]);
+            }
+        }
+    }
+
+    SampleType processLowpass(int filter, int channel, SampleType input) { return processStateVariable(filter, channel, input, false); }
+    SampleType processBandpass(int filter, int channel, SampleType input) { return processStateVariable(filter, channel, input, true); }
+
+    SampleType processBiquad(int filter, int channel, SampleType input)
+    {
+        const auto *c = biquadCoefficients[filter];
+        auto &state1 = biquadState1[filter][channel];
+        auto &state2 = biquadState2[filter][channel];
+
+        SampleType output = c[0] * input + state1;
+        state1 = c[1] * input - c[3] * output + state2;
+        state2 = c[2] * input - c[4] * output;
+        return output;
+    }
+
+    // Whole sub-block with the state held in locals, then snapped to zero like IIR::Filter::process
+    void processBiquad(int filter, int channel, SampleType *data, int numSamples)
+    {
+        const auto *c = biquadCoefficients[filter];
+        SampleType state1 = biquadState1[filter][channel];
+        SampleType state2 = biquadState2[filter][channel];
+
+        for (int sample = 0; sample < numSamples; ++sample)
+        {
+            SampleType input = data[sample];
+            SampleType output = c[0] * input + state1;
+            state1 = c[1] * input - c[3] * output + state2;
+            state2 = c[2] * input - c[4] * output;
+            data[sample] = output;
+        }
+
+        juce::dsp::util::snapToZero(state1);
+        juce::dsp::util::snapToZero(state2);
+        biquadState1[filter][channel] = state1;
+        biquadState2[filter][channel] = state2;
+    }
+
+    void resetStateVariable(int filter)
+    {
+        for (int channel = 0; channel < NUM_CHANNELS; ++channel)
+            svfState1[filter][channel] = svfState2[filter][channel] = SampleType(0);
+    }
+
+    void resetBiquad(int filter)
+    {
+        for (int channel = 0; channel < NUM_CHANNELS; ++channel)
+            biquadState1[filter][channel] = biquadState2[filter][channel] = SampleType(0);
+    }
+
+    void resetCascade(int cascade)
+    {
+        for (int section = 0; section < MAX_CASCADE_SECTIONS; ++section)
+            for (int channel = 0; channel < NUM_CHANNELS; ++channel)
+                cascadeState1[cascade][section][channel] = cascadeState2[cascade][section][channel] = 0.0;
+    }
+
+    void reset()
+    {
+        for (int filter = 0; filter < NumStateVariables; ++filter)
+            resetStateVariable(filter);
+        for (int filter = 0; filter < NumBiquads; ++filter)
+            resetBiquad(filter);
+        for (int cascade = 0; cascade < NumCascades; ++cascade)
+            resetCascade(cascade);
+    }
+
+    // Coefficients: written at control rate, read every sample
+    SampleType svfG[NumStateVariables] = {};
+    SampleType svfR2[NumStateVariables] = {};
+    SampleType svfH[NumStateVariables] = {};
+    SampleType biquadCoefficients[NumBiquads][5] = {};
+    double cascadeB0[NumCascades][MAX_CASCADE_SECTIONS] = {};
+    double cascadeB1[NumCascades][MAX_CASCADE_SECTIONS] = {};
+    double cascadeB2[NumCascades][MAX_CASCADE_SECTIONS] = {};
+    double cascadeA1[NumCascades][MAX_CASCADE_SECTIONS] = {};
+    double cascadeA2[NumCascades][MAX_CASCADE_SECTIONS] = {};
+    int cascadeSections[NumCascades] = {1, 1, 1};
+
+    // From the engine's DSPKernels table, picked for the CPU in prepare
+    void (*cascadeKernel)(CascadeBlock<SampleType> &) = nullptr;
+
+    // State: written every sample, [filter][channel]
+    SampleType svfState1[NumStateVariables][NUM_CHANNELS] = {};
+    SampleType svfState2[NumStateVariables][NUM_CHANNELS] = {};
+    SampleType biquadState1[NumBiquads][NUM_CHANNELS] = {};
+    SampleType biquadState2[NumBiquads][NUM_CHANNELS] = {};
+    double cascadeState1[NumCascades][MAX_CASCADE_SECTIONS][NUM_CHANNELS] = {};
+    double cascadeState2[NumCascades][MAX_CASCADE_SECTIONS][NUM_CHANNELS] = {};
+
+private:
+    SampleType processStateVariable(int filter, int channel, SampleType input, bool bandpass)
+    {
+        const SampleType g = svfG[filter];
+        auto &state1 = svfState1[filter][channel];
+        auto &state2 = svfState2[filter][channel];
+
+        SampleType highpass = svfH[filter] * (input - state1 * (g + svfR2[filter]) - state2);
+        SampleType band = highpass * g + state1;
+        state1 = highpass * g + band;
+        SampleType low = band * g + state2;
+        state2 = band * g + low;
+
+        return bandpass ? band : low;
+    }
+};
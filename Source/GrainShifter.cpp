@@ -0,0 +1,85 @@
+#include "GrainShifter.h"
+
+template <typename SampleType>
+void GrainShifter<SampleType>::prepare(const juce::dsp::ProcessSpec &spec)
+{
+    // 80ms grains: long enough to keep low notes intact, short enough not to smear transients much
+    grainLength = juce::jmax(NUM_VOICES, static_cast<int>(spec.sampleRate * 0.08));
+
+    // Hann windows staggered by a quarter grain sum to 2; the scale brings that back to unity
+    window.resize(static_cast<size_t>(grainLength));
+    for (int i = 0; i < grainLength; ++i)
+    {
+        auto phase = juce::MathConstants<double>::twoPi * i / grainLength;
+        window[static_cast<size_t>(i)] = static_cast<SampleType>((0.5 - 0.5 * std::cos(phase)) * 2.0 / NUM_VOICES);
+    }
+
+    channels.resize(spec.numChannels);
+    reset();
+}
+
+template <typename SampleType>
+void GrainShifter<SampleType>::reset()
+{
+    // Voices start evenly staggered, mid-grain; processSample places their read positions, since
+    // those depend on the delay and pitch it is called with
+    for (auto &state : channels)
+    {
+        for (int voice = 0; voice < NUM_VOICES; ++voice)
+        {
+            state.windowPosition[static_cast<size_t>(voice)] = voice * grainLength / NUM_VOICES;
+            state.samplesAgo[static_cast<size_t>(voice)] = SampleType(0);
+        }
+        state.seeded = false;
+    }
+}
+
+template <typename SampleType>
+void GrainShifter<SampleType>::setPitch(SampleType semitones)
+{
+    ratio = static_cast<SampleType>(std::pow(2.0, static_cast<double>(semitones) / 12.0));
+}
+
+template <typename SampleType>
+SampleType GrainShifter<SampleType>::processSample(int channel, SampleType centreDelay, const DelayManager<SampleType> &ring)
+{
+    auto &state = channels[static_cast<size_t>(channel)];
+
+    // A grain reads ratio samples per output sample while the write head moves one, so its distance
+    // behind the write head changes by ratio - 1; grains start half that sweep away from the centre
+    const SampleType drift = ratio - SampleType(1);
+    const SampleType halfSweep = std::abs(drift) * static_cast<SampleType>(grainLength) * SampleType(0.5);
+    const SampleType centre = juce::jmax(centreDelay, halfSweep + SampleType(2));
+    const SampleType grainStart = centre + drift * static_cast<SampleType>(grainLength) * SampleType(0.5);
+
+    // After a reset every voice reads as if its grain had started windowPosition samples ago, rather
+    // than from the write head until its first grain boundary
+    if (!state.seeded)
+    {
+        for (size_t voice = 0; voice < NUM_VOICES; ++voice)
+            state.samplesAgo[voice] = grainStart - drift * static_cast<SampleType>(state.windowPosition[voice]);
+        state.seeded = true;
+    }
+
+    SampleType output = 0;
+
+    for (size_t voice = 0; voice < NUM_VOICES; ++voice)
+    {
+        auto &position = state.windowPosition[voice];
+        auto &samplesAgo = state.samplesAgo[voice];
+
+        if (position == 0)
+            samplesAgo = grainStart;
+
+        output += window[static_cast<size_t>(position)] * ring.readInterpolated(channel, samplesAgo);
+
+        samplesAgo -= drift;
+        if (++position == grainLength)
+            position = 0;
+    }
+
+    return output;
+}
+
+template class GrainShifter<float>;
+template class GrainShifter<double>;
@@ -0,0 +1,39 @@
+#pragma once
+
+#include <juce_dsp/juce_dsp.h>
+#include <array>
+#include <vector>
+#include "DelayManager.h"
+
+// Granular pitch shifter that reads straight from the delay line's ring buffer. A fixed pool of
+// overlapping Hann-windowed grains sweeps across the delay tap at the transposed rate; every voice
+// runs every sample, so the cost is the same whether a grain is starting, ending or mid-flight.
+template <typename SampleType>
+class GrainShifter
+{
+public:
+    static const int NUM_VOICES = 4;
+
+    void prepare(const juce::dsp::ProcessSpec &spec);
+    void reset();
+
+    // Transposition in semitones, applied to grains as they start
+    void setPitch(SampleType semitones);
+
+    // One sample of the shifted signal around centreDelay samples ago in the ring
+    SampleType processSample(int channel, SampleType centreDelay, const DelayManager<SampleType> &ring);
+
+private:
+    // Voice state laid out lane by lane so the per-voice loops stay flat
+    struct ChannelState
+    {
+        std::array<SampleType, NUM_VOICES> samplesAgo{};
+        std::array<int, NUM_VOICES> windowPosition{};
+        bool seeded = false; // read positions are set on the first sample after a reset
+    };
+
+    std::vector<ChannelState> channels;
+    std::vector<SampleType> window; // one grain's Hann window, scaled so the overlapped voices sum to one
+    int grainLength = 1;
+    SampleType ratio = 1;
+};
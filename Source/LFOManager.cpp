@@ -1,28 +1,34 @@
 #include "LFOManager.h"
+#include "FastMath.h"
 
-LFOManager::LFOManager()
+template <typename SampleType>
+LFOManager<SampleType>::LFOManager()
     : lastKnownBPM(120.0f), sampleRate(44100.0f)
 {
-    lfo.initialise([](float x)
-                   { return std::sin(x); });
+    lfo.initialise([](SampleType x)
+                   { return FastMath::sin(x); });
 }
 
-void LFOManager::prepare(const juce::dsp::ProcessSpec &spec)
+template <typename SampleType>
+void LFOManager<SampleType>::prepare(const juce::dsp::ProcessSpec &spec)
 {
     sampleRate = static_cast<float>(spec.sampleRate);
     lfo.prepare(spec);
+    lfoBuffer.reserve(spec.maximumBlockSize); // generateBlock never grows past this, so it never allocates
     smoother.reset(sampleRate, 0.05f); // 50ms smoothing time
     isReady = true;
     DBG("LFOManager prepared. isReady set to true.");
 }
 
-void LFOManager::setFrequency(float frequency)
+template <typename SampleType>
+void LFOManager<SampleType>::setFrequency(float frequency)
 {
     DBG("Setting LFO frequency to " << frequency);
     lfo.setFrequency(frequency);
 }
 
-void LFOManager::generateBlock(int numSamples)
+template <typename SampleType>
+void LFOManager<SampleType>::generateBlock(int numSamples)
 {
     DBG("generateBlock called with numSamples: " << numSamples);
     if (!isReady)
@@ -35,32 +41,34 @@ void LFOManager::generateBlock(int numSamples)
     lfoBuffer.resize(numSamples);
     for (int i = 0; i < numSamples; ++i)
     {
-        float sample = lfo.processSample(0.0f);
+        SampleType sample = lfo.processSample(SampleType(0));
         smoother.setTargetValue(sample);
         sample = smoother.getNextValue();
-        lfoBuffer[i] = sample * 0.5f + 0.5f; // Convert from [-1, 1] to [0, 1] range
+        lfoBuffer[i] = sample * SampleType(0.5) + SampleType(0.5); // Convert from [-1, 1] to [0, 1] range
     }
 
     DBG("LFO Buffer generated. Size: " << lfoBuffer.size() << ", First: " << lfoBuffer.front() << ", Last: " << lfoBuffer.back());
 }
 
-float LFOManager::getSample(int index) const
+template <typename SampleType>
+SampleType LFOManager<SampleType>::getSample(int index) const
 {
     DBG("getSample called with index: " << index << ", buffer size: " << lfoBuffer.size());
     if (!isReady)
     {
         DBG("LFOManager not ready");
-        return 0.0f;
+        return SampleType(0);
     }
     if (index < 0 || index >= static_cast<int>(lfoBuffer.size()))
     {
         DBG("Invalid index");
-        return 0.0f;
+        return SampleType(0);
     }
     return lfoBuffer[index];
 }
 
-float LFOManager::updateFrequencyFromSync(float bpm, int syncMode)
+template <typename SampleType>
+float LFOManager<SampleType>::updateFrequencyFromSync(float bpm, int syncMode)
 {
     lastKnownBPM = bpm;
     double beatsPerSecond = bpm / 60.0;
@@ -130,4 +138,7 @@ float LFOManager::updateFrequencyFromSync(float bpm, int syncMode)
     lfoFreq = juce::jlimit(0.01f, 20.0f, lfoFreq);
     lfo.setFrequency(lfoFreq);
     return lfoFreq;
-}
\ No newline at end of file
+}
+
+template class LFOManager<float>;
+template class LFOManager<double>;
\ No newline at end of file
@@ -3,6 +3,7 @@
 #include <juce_dsp/juce_dsp.h>
 #include <vector>
 
+template <typename SampleType>
 class LFOManager
 {
 public:
@@ -10,15 +11,15 @@ public:
     void prepare(const juce::dsp::ProcessSpec &spec);
     void setFrequency(float frequency);
     void generateBlock(int numSamples);
-    float getSample(int index) const;
+    SampleType getSample(int index) const;
     float updateFrequencyFromSync(float bpm, int syncMode);
     int getBufferSize() const { return static_cast<int>(lfoBuffer.size()); }
     bool isReady;
 
 private:
-    juce::dsp::Oscillator<float> lfo;
+    juce::dsp::Oscillator<SampleType> lfo;
     float lastKnownBPM;
-    std::vector<float> lfoBuffer;
-    juce::SmoothedValue<float> smoother;
+    std::vector<SampleType> lfoBuffer;
+    juce::SmoothedValue<SampleType> smoother;
     float sampleRate;
 };
\ No newline at end of file
@@ -0,0 +1,133 @@
+#include "ModulationMatrix.h"
+#include "FastMath.h"
+
+template <typename SampleType>
+void ModulationMatrix<SampleType>::prepare(const juce::dsp::ProcessSpec &spec, int controlInterval)
+{
+    sampleRate = spec.sampleRate;
+    interval = controlInterval;
+
+    // A block starting mid-grid touches one more sub-block than it fills
+    maxSubBlocks = static_cast<int>(spec.maximumBlockSize) / interval + 2;
+    for (auto &values : sourceValues)
+        values.assign(static_cast<size_t>(maxSubBlocks), SampleType(0));
+    for (auto &values : destinationValues)
+        values.assign(static_cast<size_t>(maxSubBlocks), SampleType(0));
+
+    // 10ms attack, 200ms release
+    envelopeAttack = static_cast<SampleType>(1.0 - std::exp(-1.0 / (0.01 * sampleRate)));
+    envelopeRelease = static_cast<SampleType>(1.0 - std::exp(-1.0 / (0.2 * sampleRate)));
+
+    reset();
+}
+
+template <typename SampleType>
+void ModulationMatrix<SampleType>::reset()
+{
+    lfo1Phase = 0.0;
+    lfo2Phase = 0.0;
+    envelope = SampleType(0);
+    heldValues.fill(SampleType(0));
+    numSubBlocks = 0;
+}
+
+template <typename SampleType>
+void ModulationMatrix<SampleType>::setRoutes(const ModulationRoutes &routes)
+{
+    numActiveRoutes = 0;
+    sourceUsed.fill(false);
+    destinationRouted.fill(false);
+
+    for (const auto &route : routes)
+    {
+        if (route.source <= ModulationRoute::NoSource || route.source >= ModulationRoute::NumSources ||
+            route.destination < 0 || route.destination >= ModulationRoute::NumDestinations || route.depth == 0.0f)
+            continue;
+
+        auto index = static_cast<size_t>(numActiveRoutes++);
+        routeSources[index] = route.source;
+        routeDestinations[index] = route.destination;
+        routeDepths[index] = static_cast<SampleType>(route.depth);
+        sourceUsed[static_cast<size_t>(route.source)] = true;
+        destinationRouted[static_cast<size_t>(route.destination)] = true;
+    }
+}
+
+template <typename SampleType>
+void ModulationMatrix<SampleType>::renderSources(const juce::AudioBuffer<SampleType> &input, int numInputChannels, int numSamples,
+                                                 int gridPhase, float lfo1Frequency, float lfo2Frequency)
+{
+    const double lfo1Increment = juce::MathConstants<double>::twoPi * lfo1Frequency / sampleRate;
+    const double lfo2Increment = juce::MathConstants<double>::twoPi * lfo2Frequency / sampleRate;
+
+    numSubBlocks = 0;
+    for (int start = 0, phase = gridPhase; start < numSamples;)
+    {
+        int length = juce::jmin(interval - phase, numSamples - start);
+        auto subBlock = static_cast<size_t>(juce::jmin(numSubBlocks, maxSubBlocks - 1));
+        jassert(numSubBlocks < maxSubBlocks); // host block larger than prepare promised
+
+        // New values are taken on grid points only, a block starting mid-grid keeps the previous ones
+        if (phase == 0)
+        {
+            heldValues[ModulationRoute::LFO1] = static_cast<SampleType>(FastMath::sin(lfo1Phase));
+            heldValues[ModulationRoute::LFO2] = static_cast<SampleType>(FastMath::sin(lfo2Phase));
+            heldValues[ModulationRoute::Envelope] = juce::jmin(SampleType(1), envelope);
+        }
+
+        for (int source = ModulationRoute::LFO1; source < ModulationRoute::NumSources; ++source)
+            if (sourceUsed[static_cast<size_t>(source)])
+                sourceValues[static_cast<size_t>(source)][subBlock] = heldValues[static_cast<size_t>(source)];
+
+        lfo1Phase = std::fmod(lfo1Phase + lfo1Increment * length, juce::MathConstants<double>::twoPi);
+        lfo2Phase = std::fmod(lfo2Phase + lfo2Increment * length, juce::MathConstants<double>::twoPi);
+
+        if (sourceUsed[ModulationRoute::Envelope])
+        {
+            for (int i = start; i < start + length; ++i)
+            {
+                SampleType level = 0;
+                for (int channel = 0; channel < numInputChannels; ++channel)
+                    level = juce::jmax(level, std::abs(input.getSample(channel, i)));
+
+                envelope += (level > envelope ? envelopeAttack : envelopeRelease) * (level - envelope);
+            }
+        }
+
+        ++numSubBlocks;
+        phase = (phase + length) % interval;
+        start += length;
+    }
+}
+
+template <typename SampleType>
+void ModulationMatrix<SampleType>::process(const juce::AudioBuffer<SampleType> &input, int numInputChannels, int numSamples, int gridPhase,
+                                           float lfo1Frequency, float lfo2Frequency)
+{
+    renderSources(input, numInputChannels, numSamples, gridPhase, lfo1Frequency, lfo2Frequency);
+
+    int count = juce::jmin(numSubBlocks, maxSubBlocks);
+
+    for (int destination = 0; destination < ModulationRoute::NumDestinations; ++destination)
+        if (destinationRouted[static_cast<size_t>(destination)])
+            std::fill_n(destinationValues[static_cast<size_t>(destination)].begin(), count, SampleType(0));
+
+    for (int route = 0; route < numActiveRoutes; ++route)
+    {
+        const auto *source = sourceValues[static_cast<size_t>(routeSources[static_cast<size_t>(route)])].data();
+        auto *destination = destinationValues[static_cast<size_t>(routeDestinations[static_cast<size_t>(route)])].data();
+        const auto depth = routeDepths[static_cast<size_t>(route)];
+
+        for (int i = 0; i < count; ++i)
+            destination[i] += depth * source[i];
+    }
+}
+
+template <typename SampleType>
+SampleType ModulationMatrix<SampleType>::getModulation(ModulationRoute::Destination destination, int subBlock) const
+{
+    return destinationValues[static_cast<size_t>(destination)][static_cast<size_t>(juce::jmin(subBlock, maxSubBlocks - 1))];
+}
+
+template class ModulationMatrix<float>;
+template class ModulationMatrix<double>;
@@ -0,0 +1,92 @@
+#pragma once
+
+#include <juce_dsp/juce_dsp.h>
+#include <array>
+#include <vector>
+
+// One slot of the modulation matrix: a source driving a destination by depth (-1 to 1)
+struct ModulationRoute
+{
+    enum Source
+    {
+        NoSource,
+        LFO1,     // sine at the main LFO rate
+        LFO2,     // sine at its own rate
+        Envelope, // follower on the input level, 0 to 1
+        NumSources
+    };
+
+    enum Destination
+    {
+        Delay,
+        Feedback,
+        Mix,
+        Bitcrush,
+        StereoWidth,
+        Pan,
+        Highpass,
+        Lowpass,
+        Shimmer,
+        NumDestinations
+    };
+
+    static const int MAX_ROUTES = 4;
+
+    int source = NoSource;
+    int destination = Delay;
+    float depth = 0.0f;
+};
+
+using ModulationRoutes = std::array<ModulationRoute, ModulationRoute::MAX_ROUTES>;
+
+// Control-rate modulation. Once per host block every source that feeds a route is rendered into its
+// own array, one value per sub-block, and the compiled routes are summed into per-destination arrays
+// in a single pass. Unused sources, empty routes and unrouted destinations are never touched.
+template <typename SampleType>
+class ModulationMatrix
+{
+public:
+    // controlInterval is the engine's sub-block size; values are taken on that grid
+    void prepare(const juce::dsp::ProcessSpec &spec, int controlInterval);
+    void reset();
+
+    // Compiles the routes with a source and non-zero depth into the flat route arrays
+    void setRoutes(const ModulationRoutes &routes);
+    bool hasRoutes() const { return numActiveRoutes > 0; }
+    bool isRouted(ModulationRoute::Destination destination) const { return destinationRouted[destination]; }
+
+    // Renders the host block. gridPhase is how far into a sub-block the block starts, as in the engine.
+    void process(const juce::AudioBuffer<SampleType> &input, int numInputChannels, int numSamples, int gridPhase,
+                 float lfo1Frequency, float lfo2Frequency);
+
+    // Summed modulation for the destination during the given sub-block of the last processed host block
+    SampleType getModulation(ModulationRoute::Destination destination, int subBlock) const;
+
+private:
+    void renderSources(const juce::AudioBuffer<SampleType> &input, int numInputChannels, int numSamples, int gridPhase,
+                       float lfo1Frequency, float lfo2Frequency);
+
+    // Structure of arrays: one run of sub-block values per source and per destination
+    std::array<std::vector<SampleType>, ModulationRoute::NumSources> sourceValues;
+    std::array<std::vector<SampleType>, ModulationRoute::NumDestinations> destinationValues;
+    int numSubBlocks = 0;
+    int maxSubBlocks = 0;
+
+    // Compiled routes, also laid out as parallel arrays
+    std::array<int, ModulationRoute::MAX_ROUTES> routeSources{};
+    std::array<int, ModulationRoute::MAX_ROUTES> routeDestinations{};
+    std::array<SampleType, ModulationRoute::MAX_ROUTES> routeDepths{};
+    int numActiveRoutes = 0;
+    std::array<bool, ModulationRoute::NumSources> sourceUsed{};
+    std::array<bool, ModulationRoute::NumDestinations> destinationRouted{};
+
+    // Source state, advanced per sample so control values don't depend on the host block size
+    std::array<SampleType, ModulationRoute::NumSources> heldValues{};
+    double lfo1Phase = 0.0;
+    double lfo2Phase = 0.0;
+    SampleType envelope = 0;
+    SampleType envelopeAttack = 0;
+    SampleType envelopeRelease = 0;
+    double sampleRate = 44100.0;
+    int interval = 32;
+};
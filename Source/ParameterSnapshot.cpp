@@ -0,0 +1,176 @@
+#include "ParameterSnapshot.h"
+
+namespace
+{
+    const char *const parameterIDs[ParameterSnapshot::NumParameters] = {
+        "waveshapeAmount", "delay", "feedback", "mix", "bitcrush", "stereoWidth", "pan",
+        "highpassFreq", "lowpassFreq", "lfoFreq", "lfoAmount", "tempoSync", "lfoTempoSync",
+        "lfoBitcrush", "lfoHighpass", "lfoLowpass", "lfoPan", "smear", "lfoDelay", "morph", "morphEnabled", "delayJump", "fdnLines", "freeze", "shimmer", "shimmerPitch", "reverse", "lfo2Freq", "filterSlope", "spectral", "spectralHop", "spectralTilt",
+        "modSource1", "modDestination1", "modDepth1", "modSource2", "modDestination2", "modDepth2",
+        "modSource3", "modDestination3", "modDepth3", "modSource4", "modDestination4", "modDepth4"};
+}
+
+const char *ParameterSnapshot::getParameterID(int index)
+{
+    jassert(index >= 0 && index < NumParameters);
+    return parameterIDs[index];
+}
+
+int ParameterSnapshot::findParameterIndex(const juce::String &parameterID)
+{
+    for (int i = 0; i < NumParameters; ++i)
+        if (parameterID == parameterIDs[i])
+            return i;
+
+    return -1;
+}
+
+ParameterSnapshot ParameterSnapshot::capture(juce::AudioProcessorValueTreeState &state)
+{
+    ParameterSnapshot snapshot;
+
+    for (int i = 0; i < NumParameters; ++i)
+        if (auto *value = state.getRawParameterValue(parameterIDs[i]))
+            snapshot[i] = value->load();
+
+    return snapshot;
+}
+
+void ParameterSnapshot::applyTo(juce::AudioProcessorValueTreeState &state) const
+{
+    for (int i = 0; i < NumParameters; ++i)
+    {
+        if (auto *param = state.getParameter(parameterIDs[i]))
+        {
+            float normalised = param->convertTo0to1((*this)[i]);
+            if (param->getValue() != normalised)
+                param->setValueNotifyingHost(normalised);
+        }
+    }
+}
+
+void ParameterSnapshot::constrainTo(juce::AudioProcessorValueTreeState &state)
+{
+    for (int i = 0; i < NumParameters; ++i)
+        if (auto *param = state.getParameter(parameterIDs[i]))
+            (*this)[i] = param->convertFrom0to1(param->convertTo0to1((*this)[i]));
+}
+
+ParameterSnapshot ParameterSnapshot::interpolate(const ParameterSnapshot &a, const ParameterSnapshot &b, float position)
+{
+    ParameterSnapshot result = a;
+    position = juce::jlimit(0.0f, 1.0f, position);
+
+    auto linear = [&](int index)
+    {
+        result[index] = a[index] + position * (b[index] - a[index]);
+    };
+
+    // Cutoffs and rates are always positive, and sweep more evenly on a log scale
+    auto geometric = [&](int index)
+    {
+        if (a[index] > 0.0f && b[index] > 0.0f)
+            result[index] = a[index] * std::pow(b[index] / a[index], position);
+        else
+            linear(index);
+    };
+
+    auto stepped = [&](int index)
+    {
+        result[index] = position < 0.5f ? a[index] : b[index];
+    };
+
+    linear(WaveshapeAmount);
+    linear(Delay);
+    linear(Feedback);
+    linear(Mix);
+    linear(Bitcrush);
+    linear(StereoWidth);
+    linear(Pan);
+    geometric(HighpassFreq);
+    geometric(LowpassFreq);
+    geometric(LFOFreq);
+    linear(LFOAmount);
+    stepped(TempoSync);
+    stepped(LFOTempoSync);
+    stepped(LFOBitcrush);
+    stepped(LFOHighpass);
+    stepped(LFOLowpass);
+    stepped(LFOPan);
+    linear(Smear);
+    stepped(LFODelay);
+    stepped(DelayJump);
+    stepped(FDNLines);
+    stepped(Freeze);
+    linear(Shimmer);
+    stepped(ShimmerPitch);
+    stepped(Reverse);
+    geometric(LFO2Freq);
+    stepped(FilterSlope);
+    stepped(Spectral);
+    stepped(SpectralHop);
+    linear(SpectralTilt);
+
+    for (int route = ModSource1; route < NumParameters; route += PARAMETERS_PER_ROUTE)
+    {
+        stepped(route);
+        stepped(route + 1);
+        linear(route + 2);
+    }
+
+    return result;
+}
+
+bool ParameterSnapshot::isBinaryState(const void *data, int sizeInBytes)
+{
+    if (data == nullptr || sizeInBytes < 12)
+        return false;
+
+    return static_cast<juce::int32>(juce::ByteOrder::littleEndianInt(data)) == BINARY_MAGIC;
+}
+
+void ParameterSnapshot::writeHeader(juce::OutputStream &stream)
+{
+    stream.writeInt(BINARY_MAGIC);
+    stream.writeInt(BINARY_VERSION);
+}
+
+int ParameterSnapshot::readHeader(juce::InputStream &stream)
+{
+    if (stream.readInt() != BINARY_MAGIC)
+        return -1;
+
+    return stream.readInt();
+}
+
+void ParameterSnapshot::writeTo(juce::OutputStream &stream) const
+{
+    stream.writeInt(NumParameters);
+
+    for (int i = 0; i < NumParameters; ++i)
+    {
+        stream.writeString(parameterIDs[i]);
+        stream.writeFloat((*this)[i]);
+    }
+}
+
+void ParameterSnapshot::readFrom(juce::InputStream &stream)
+{
+    auto numEntries = stream.readInt();
+
+    for (int entry = 0; entry < numEntries && !stream.isExhausted(); ++entry)
+    {
+        auto parameterID = stream.readString();
+
+        // A stream cut off inside an entry would read its value as 0; leave that parameter alone
+        auto remaining = stream.getNumBytesRemaining();
+        if (stream.isExhausted() || (remaining >= 0 && remaining < static_cast<juce::int64>(sizeof(float))))
+            break;
+
+        auto value = stream.readFloat();
+
+        int index = findParameterIndex(parameterID);
+        if (index >= 0 && std::isfinite(value))
+            (*this)[index] = value;
+    }
+}
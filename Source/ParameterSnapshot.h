@@ -0,0 +1,100 @@
+#pragma once
+
+#include <juce_audio_processors/juce_audio_processors.h>
+#include <array>
+
+// Plain values of every parameter in createParameterLayout, in a fixed order.
+// Used for the binary state format and the preset bank, so neither touches ValueTree or XML.
+struct ParameterSnapshot
+{
+    enum ParameterIndex
+    {
+        WaveshapeAmount,
+        Delay,
+        Feedback,
+        Mix,
+        Bitcrush,
+        StereoWidth,
+        Pan,
+        HighpassFreq,
+        LowpassFreq,
+        LFOFreq,
+        LFOAmount,
+        TempoSync,
+        LFOTempoSync,
+        LFOBitcrush,
+        LFOHighpass,
+        LFOLowpass,
+        LFOPan,
+        Smear,
+        LFODelay,
+        Morph,
+        MorphEnabled,
+        DelayJump,
+        FDNLines,
+        Freeze,
+        Shimmer,
+        ShimmerPitch,
+        Reverse,
+        LFO2Freq,
+        FilterSlope,
+        Spectral,
+        SpectralHop,
+        SpectralTilt,
+        ModSource1, // each route slot is source, destination, depth
+        ModDestination1,
+        ModDepth1,
+        ModSource2,
+        ModDestination2,
+        ModDepth2,
+        ModSource3,
+        ModDestination3,
+        ModDepth3,
+        ModSource4,
+        ModDestination4,
+        ModDepth4,
+        NumParameters
+    };
+
+    static const int PARAMETERS_PER_ROUTE = ModSource2 - ModSource1;
+
+    static const char *getParameterID(int index);
+    static int findParameterIndex(const juce::String &parameterID);
+
+    static ParameterSnapshot capture(juce::AudioProcessorValueTreeState &state);
+
+    // Sets every parameter through the host-notifying path; the audio thread sees the values on its next block
+    void applyTo(juce::AudioProcessorValueTreeState &state) const;
+
+    // Pulls every value into its parameter's range and onto its steps, for snapshots that reach the
+    // engine without going through the parameters themselves
+    void constrainTo(juce::AudioProcessorValueTreeState &state);
+
+    float &operator[](int index) { return values[static_cast<size_t>(index)]; }
+    float operator[](int index) const { return values[static_cast<size_t>(index)]; }
+
+    // Blend between two snapshots. Continuous values are interpolated (frequencies geometrically),
+    // choices and switches flip at the halfway point. The morph controls themselves are taken from a.
+    static ParameterSnapshot interpolate(const ParameterSnapshot &a, const ParameterSnapshot &b, float position);
+
+    // Binary state: magic and version, then one or more snapshots, each an entry count followed by
+    // (parameter ID, plain value) pairs. Entries are keyed by ID so older or newer layouts load
+    // whatever they have in common.
+    //   version 1: live parameters
+    //   version 2: live parameters, morph snapshot A, morph snapshot B
+    static const juce::int32 BINARY_MAGIC = 0x594c4441; // "ADLY"
+    static const juce::int32 BINARY_VERSION = 2;
+
+    static bool isBinaryState(const void *data, int sizeInBytes);
+    static void writeHeader(juce::OutputStream &stream);
+
+    // Returns the version, or -1 if the stream doesn't start with a binary state header
+    static int readHeader(juce::InputStream &stream);
+
+    void writeTo(juce::OutputStream &stream) const;
+
+    // Entries missing from the stream, or holding a non-finite value, keep their current value
+    void readFrom(juce::InputStream &stream);
+
+    std::array<float, NumParameters> values{};
+};
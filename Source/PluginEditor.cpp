@@ -2,9 +2,10 @@
 #include "PluginEditor.h"
 
 AudioDelayAudioProcessorEditor::AudioDelayAudioProcessorEditor(AudioDelayAudioProcessor &p)
-    : AudioProcessorEditor(&p), audioProcessor(p)
+    : AudioProcessorEditor(&p), audioProcessor(p), profilerOverlay(p.getProfiler()), scopeView(p.getScopeFifo())
 {
-  setSize(700, 500);
+  setOpaque(true);
+  setSize(700, 500 + MOD_STRIP_HEIGHT);
 
   auto setupSwitch = [this](juce::ToggleButton &button, juce::Label &label, const juce::String &labelText)
   {
@@ -72,6 +73,8 @@ AudioDelayAudioProcessorEditor::AudioDelayAudioProcessorEditor(AudioDelayAudioPr
   setupKnob(lowpassFreqKnob, lowpassFreqLabel, "Lowpass", 2000.0, 20000.0, 1.0);
   setupKnob(lfoFreqKnob, lfoFreqLabel, "LFO Freq", 0.1, 20.0, 0.1);
   setupKnob(lfoAmountKnob, lfoAmountLabel, "LFO Amount", 0.0, 1.0, 0.01);
+  setupKnob(morphKnob, morphLabel, "Morph A/B", 0.0, 1.0, 0.01);
+  setupKnob(shimmerKnob, shimmerLabel, "Shimmer", 0.0, 1.0, 0.01);
 
   smearAttachment = std::make_unique<juce::AudioProcessorValueTreeState::SliderAttachment>(
       audioProcessor.getParameters(), "smear", smearKnob);
@@ -95,6 +98,130 @@ AudioDelayAudioProcessorEditor::AudioDelayAudioProcessorEditor(AudioDelayAudioPr
       audioProcessor.getParameters(), "lfoFreq", lfoFreqKnob);
   lfoAmountAttachment = std::make_unique<juce::AudioProcessorValueTreeState::SliderAttachment>(
       audioProcessor.getParameters(), "lfoAmount", lfoAmountKnob);
+  morphAttachment = std::make_unique<juce::AudioProcessorValueTreeState::SliderAttachment>(
+      audioProcessor.getParameters(), "morph", morphKnob);
+  shimmerAttachment = std::make_unique<juce::AudioProcessorValueTreeState::SliderAttachment>(
+      audioProcessor.getParameters(), "shimmer", shimmerKnob);
+
+  shimmerPitchBox.addItem("-12", 1);
+  shimmerPitchBox.addItem("+5", 2);
+  shimmerPitchBox.addItem("+7", 3);
+  shimmerPitchBox.addItem("+12", 4);
+  addAndMakeVisible(shimmerPitchBox);
+  shimmerPitchAttachment = std::make_unique<juce::AudioProcessorValueTreeState::ComboBoxAttachment>(
+      audioProcessor.getParameters(), "shimmerPitch", shimmerPitchBox);
+
+  // Morph: store the current settings as either end point, then sweep between them
+  morphSwitch.setButtonText("Morph");
+  morphSwitch.setColour(juce::ToggleButton::tickColourId, juce::Colours::red);
+  morphSwitch.setColour(juce::ToggleButton::textColourId, juce::Colours::black);
+  addAndMakeVisible(morphSwitch);
+  morphEnabledAttachment = std::make_unique<juce::AudioProcessorValueTreeState::ButtonAttachment>(
+      audioProcessor.getParameters(), "morphEnabled", morphSwitch);
+
+  storeMorphAButton.setButtonText("Store A");
+  storeMorphAButton.onClick = [this]
+  { audioProcessor.storeMorphSnapshot(0); };
+  addAndMakeVisible(storeMorphAButton);
+
+  storeMorphBButton.setButtonText("Store B");
+  storeMorphBButton.onClick = [this]
+  { audioProcessor.storeMorphSnapshot(1); };
+  addAndMakeVisible(storeMorphBButton);
+
+  delayJumpSwitch.setButtonText("Jump");
+  delayJumpSwitch.setColour(juce::ToggleButton::tickColourId, juce::Colours::red);
+  delayJumpSwitch.setColour(juce::ToggleButton::textColourId, juce::Colours::black);
+  addAndMakeVisible(delayJumpSwitch);
+  delayJumpAttachment = std::make_unique<juce::AudioProcessorValueTreeState::ButtonAttachment>(
+      audioProcessor.getParameters(), "delayJump", delayJumpSwitch);
+
+  auto setupStripSlider = [this](juce::Slider &slider, double rangeStart, double rangeEnd, double interval)
+  {
+    slider.setSliderStyle(juce::Slider::LinearHorizontal);
+    slider.setTextBoxStyle(juce::Slider::TextBoxRight, false, 50, 20);
+    slider.setRange(rangeStart, rangeEnd, interval);
+    slider.setColour(juce::Slider::textBoxTextColourId, juce::Colours::black);
+    slider.setColour(juce::Slider::textBoxOutlineColourId, juce::Colours::black);
+    addAndMakeVisible(slider);
+  };
+
+  for (int slot = 0; slot < ModulationRoute::MAX_ROUTES; ++slot)
+  {
+    juce::String suffix(slot + 1);
+    auto index = static_cast<size_t>(slot);
+
+    modSourceBoxes[index].addItemList({"Off", "LFO 1", "LFO 2", "Envelope"}, 1);
+    addAndMakeVisible(modSourceBoxes[index]);
+    modSourceAttachments[index] = std::make_unique<juce::AudioProcessorValueTreeState::ComboBoxAttachment>(
+        audioProcessor.getParameters(), "modSource" + suffix, modSourceBoxes[index]);
+
+    modDestinationBoxes[index].addItemList({"Delay", "Feedback", "Mix", "Bitcrush", "Stereo Width", "Pan", "Highpass", "Lowpass", "Shimmer"}, 1);
+    addAndMakeVisible(modDestinationBoxes[index]);
+    modDestinationAttachments[index] = std::make_unique<juce::AudioProcessorValueTreeState::ComboBoxAttachment>(
+        audioProcessor.getParameters(), "modDestination" + suffix, modDestinationBoxes[index]);
+
+    setupStripSlider(modDepthSliders[index], -1.0, 1.0, 0.01);
+    modDepthAttachments[index] = std::make_unique<juce::AudioProcessorValueTreeState::SliderAttachment>(
+        audioProcessor.getParameters(), "modDepth" + suffix, modDepthSliders[index]);
+  }
+
+  setupStripSlider(lfo2FreqSlider, 0.01, 20.0, 0.01);
+  lfo2FreqAttachment = std::make_unique<juce::AudioProcessorValueTreeState::SliderAttachment>(
+      audioProcessor.getParameters(), "lfo2Freq", lfo2FreqSlider);
+  lfo2FreqLabel.setText("LFO 2", juce::dontSendNotification);
+  lfo2FreqLabel.setJustificationType(juce::Justification::centred);
+  addAndMakeVisible(lfo2FreqLabel);
+
+  setupStripSlider(spectralTiltSlider, -1.0, 1.0, 0.01);
+  spectralTiltSlider.setTextValueSuffix(" tilt");
+  spectralTiltAttachment = std::make_unique<juce::AudioProcessorValueTreeState::SliderAttachment>(
+      audioProcessor.getParameters(), "spectralTilt", spectralTiltSlider);
+
+  reverseSwitch.setButtonText("Reverse");
+  reverseSwitch.setColour(juce::ToggleButton::tickColourId, juce::Colours::red);
+  reverseSwitch.setColour(juce::ToggleButton::textColourId, juce::Colours::black);
+  addAndMakeVisible(reverseSwitch);
+  reverseAttachment = std::make_unique<juce::AudioProcessorValueTreeState::ButtonAttachment>(
+      audioProcessor.getParameters(), "reverse", reverseSwitch);
+
+  freezeSwitch.setButtonText("Freeze");
+  freezeSwitch.setColour(juce::ToggleButton::tickColourId, juce::Colours::red);
+  freezeSwitch.setColour(juce::ToggleButton::textColourId, juce::Colours::black);
+  addAndMakeVisible(freezeSwitch);
+  freezeAttachment = std::make_unique<juce::AudioProcessorValueTreeState::ButtonAttachment>(
+      audioProcessor.getParameters(), "freeze", freezeSwitch);
+
+  spectralSwitch.setButtonText("Spectral");
+  spectralSwitch.setColour(juce::ToggleButton::tickColourId, juce::Colours::red);
+  spectralSwitch.setColour(juce::ToggleButton::textColourId, juce::Colours::black);
+  addAndMakeVisible(spectralSwitch);
+  spectralAttachment = std::make_unique<juce::AudioProcessorValueTreeState::ButtonAttachment>(
+      audioProcessor.getParameters(), "spectral", spectralSwitch);
+
+  spectralHopBox.addItem("Hop 128", 1);
+  spectralHopBox.addItem("Hop 256", 2);
+  spectralHopBox.addItem("Hop 512", 3);
+  spectralHopBox.addItem("Hop 1024", 4);
+  addAndMakeVisible(spectralHopBox);
+  spectralHopAttachment = std::make_unique<juce::AudioProcessorValueTreeState::ComboBoxAttachment>(
+      audioProcessor.getParameters(), "spectralHop", spectralHopBox);
+
+  networkBox.addItem("Single", 1);
+  networkBox.addItem("FDN 4", 2);
+  networkBox.addItem("FDN 8", 3);
+  networkBox.addItem("FDN 16", 4);
+  addAndMakeVisible(networkBox);
+  networkAttachment = std::make_unique<juce::AudioProcessorValueTreeState::ComboBoxAttachment>(
+      audioProcessor.getParameters(), "fdnLines", networkBox);
+
+  filterSlopeBox.addItem("12 dB/oct", 1);
+  filterSlopeBox.addItem("24 dB/oct", 2);
+  filterSlopeBox.addItem("36 dB/oct", 3);
+  filterSlopeBox.addItem("48 dB/oct", 4);
+  addAndMakeVisible(filterSlopeBox);
+  filterSlopeAttachment = std::make_unique<juce::AudioProcessorValueTreeState::ComboBoxAttachment>(
+      audioProcessor.getParameters(), "filterSlope", filterSlopeBox);
 
   tempoSyncBox.addItem("Free", 1);
   tempoSyncBox.addItem("1/1", 2);
@@ -151,10 +278,32 @@ AudioDelayAudioProcessorEditor::AudioDelayAudioProcessorEditor(AudioDelayAudioPr
 
   updateDelayKnob();
 
+  // CPU overlay: turning it on also starts the processor's stage profiler
+  profilerSwitch.setButtonText("CPU");
+  profilerSwitch.setColour(juce::ToggleButton::tickColourId, juce::Colours::red);
+  profilerSwitch.setColour(juce::ToggleButton::textColourId, juce::Colours::black);
+  profilerSwitch.setToggleState(audioProcessor.getProfiler().isEnabled(), juce::dontSendNotification);
+  profilerSwitch.onClick = [this]
+  {
+    bool enabled = profilerSwitch.getToggleState();
+    audioProcessor.getProfiler().setEnabled(enabled);
+    if (enabled)
+      audioProcessor.getProfiler().reset();
+    profilerOverlay.setVisible(enabled);
+  };
+  addAndMakeVisible(profilerSwitch);
+  addAndMakeVisible(scopeView);
+  addChildComponent(profilerOverlay);
+  profilerOverlay.setVisible(profilerSwitch.getToggleState());
+
   lfoBitcrushSwitch.toFront(false);
   lfoHighpassSwitch.toFront(false);
   lfoLowpassSwitch.toFront(false);
   lfoPanSwitch.toFront(false);
+
+  // Styling is static, so apply it once here rather than on every repaint
+  setAllLabelsBlack();
+  setAllKnobsBlack();
 }
 
 AudioDelayAudioProcessorEditor::~AudioDelayAudioProcessorEditor()
@@ -173,20 +322,40 @@ void AudioDelayAudioProcessorEditor::updateDelayKnob()
 
 void AudioDelayAudioProcessorEditor::paint(juce::Graphics &g)
 {
+  if (background.isValid())
+    g.drawImageAt(background, 0, 0);
+  else
+    g.fillAll(juce::Colours::white);
+}
+
+void AudioDelayAudioProcessorEditor::renderBackground()
+{
+  background = juce::Image(juce::Image::RGB, juce::jmax(1, getWidth()), juce::jmax(1, getHeight()), true);
+  juce::Graphics g(background);
+
   g.fillAll(juce::Colours::white);
-  setAllLabelsBlack();
-  setAllKnobsBlack();
+
+  // Faint rules between the knob, switch and bottom rows, and above the modulation strip
+  auto area = getLocalBounds().reduced(20);
+  int height = (area.getHeight() - MOD_STRIP_HEIGHT) / 4;
+  g.setColour(juce::Colours::black.withAlpha(0.08f));
+  for (int row = 1; row <= 4; ++row)
+    g.drawHorizontalLine(height * row - 1, 0.0f, static_cast<float>(getWidth()));
 }
 
 void AudioDelayAudioProcessorEditor::resized()
 {
+  renderBackground();
+
   auto area = getLocalBounds().reduced(20);
   int width = area.getWidth() / 5;
-  int height = area.getHeight() / 4; // Changed from 3 to 4 to add more vertical space
+  int height = (area.getHeight() - MOD_STRIP_HEIGHT) / 4; // Changed from 3 to 4 to add more vertical space
 
   tempoSyncBox.setBounds(width * 0, height * 0, width, 20);
   delayKnob.setBounds(width * 0, height * 0 + 20, width, height - 20);
 
+  networkBox.setBounds(width * 1, height * 0, width, 20);
+
   lfoTempoSyncBox.setBounds(width * 3, height * 1, width, 20);
   lfoTempoSyncLabel.setBounds(width * 3, height * 1 + 20, width, 20);
 
@@ -207,6 +376,12 @@ void AudioDelayAudioProcessorEditor::resized()
   layoutSwitch(lfoLowpassSwitch, lfoLowpassLabel, 2, 2);
   layoutSwitch(lfoPanSwitch, lfoPanLabel, 3, 2);
   layoutSwitch(lfoDelaySwitch, lfoDelayLabel, 4, 2);
+  freezeSwitch.setBounds(width * 4, height * 2 + 50, width, 20);
+  filterSlopeBox.setBounds(width * 2, height * 2 + 50, width, 20);
+  spectralSwitch.setBounds(width * 0, height * 2 + 50, width, 20);
+  spectralHopBox.setBounds(width * 1, height * 2 + 50, width, 20);
+  spectralTiltSlider.setBounds(width * 0, height * 2 + 75, width * 2, 20);
+  reverseSwitch.setBounds(width * 4, height * 2 + 75, width, 20);
 
   auto layoutKnob = [this, width, height](juce::Slider &knob, juce::Label &label, int row, int col)
   {
@@ -229,6 +404,14 @@ void AudioDelayAudioProcessorEditor::resized()
 
   // Moved smear knob to the bottom row
   layoutKnob(smearKnob, smearLabel, 3, 2);
+  layoutKnob(morphKnob, morphLabel, 3, 3);
+  layoutKnob(shimmerKnob, shimmerLabel, 3, 1);
+  shimmerPitchBox.setBounds(width * 1, height * 3, width, 20);
+
+  morphSwitch.setBounds(width * 4, height * 3, width, 20);
+  storeMorphAButton.setBounds(width * 4, height * 3 + 25, width / 2 - 2, 22);
+  storeMorphBButton.setBounds(width * 4 + width / 2 + 2, height * 3 + 25, width / 2 - 2, 22);
+  delayJumpSwitch.setBounds(width * 4, height * 3 + 55, width, 20);
 
   // Ensure the switches are visible and not overlapped
   lfoBitcrushSwitch.toFront(false);
@@ -236,6 +419,27 @@ void AudioDelayAudioProcessorEditor::resized()
   lfoLowpassSwitch.toFront(false);
   lfoPanSwitch.toFront(false);
   lfoDelaySwitch.toFront(false);
+
+  // Modulation strip: one route per column, the second LFO's rate on the right
+  int stripY = height * 4 + 10;
+  for (int slot = 0; slot < ModulationRoute::MAX_ROUTES; ++slot)
+  {
+    auto index = static_cast<size_t>(slot);
+    modSourceBoxes[index].setBounds(width * slot, stripY, width / 2 - 2, 20);
+    modDestinationBoxes[index].setBounds(width * slot + width / 2 + 2, stripY, width / 2 - 2, 20);
+    modDepthSliders[index].setBounds(width * slot, stripY + 25, width, 20);
+  }
+  lfo2FreqLabel.setBounds(width * 4, stripY, width, 20);
+  lfo2FreqSlider.setBounds(width * 4, stripY + 25, width, 20);
+
+  // Scope fills the free space left of the shimmer knob
+  scopeView.setBounds(width * 0 + 10, height * 3 + 10, width - 20, height - 20);
+
+  // CPU overlay sits over the switch and smear rows, its toggle in the bottom right corner
+  profilerSwitch.setBounds(width * 4, height * 3 + height - 30, width, 20);
+  profilerOverlay.setBounds(width * 0, height * 2, width * 4, height * 2);
+  profilerOverlay.toFront(false);
+  profilerSwitch.toFront(false);
 }
 
 void AudioDelayAudioProcessorEditor::setAllLabelsBlack()
@@ -244,8 +448,8 @@ void AudioDelayAudioProcessorEditor::setAllLabelsBlack()
       &delayLabel, &feedbackLabel, &mixLabel, &bitcrushLabel, &stereoWidthLabel,
       &panLabel, &highpassFreqLabel, &lowpassFreqLabel, &lfoFreqLabel, &lfoAmountLabel,
       &smearLabel, &lfoBitcrushLabel, &lfoHighpassLabel, &lfoLowpassLabel, &lfoPanLabel,
-      &lfoDelayLabel // Add this line to include the new LFO delay label
-  };
+      &lfoDelayLabel, // Add this line to include the new LFO delay label
+      &morphLabel, &shimmerLabel, &lfo2FreqLabel};
 
   for (auto *label : labels)
   {
@@ -258,7 +462,7 @@ void AudioDelayAudioProcessorEditor::setAllKnobsBlack()
   juce::Slider *knobs[] = {
       &delayKnob, &feedbackKnob, &mixKnob, &bitcrushKnob, &stereoWidthKnob,
       &panKnob, &highpassFreqKnob, &lowpassFreqKnob, &lfoFreqKnob, &lfoAmountKnob,
-      &smearKnob};
+      &smearKnob, &morphKnob, &shimmerKnob};
 
   for (auto *knob : knobs)
   {
@@ -3,6 +3,8 @@
 #include <juce_audio_processors/juce_audio_processors.h>
 #include <juce_gui_basics/juce_gui_basics.h>
 #include "PluginProcessor.h"
+#include "ProfilerOverlay.h"
+#include "ScopeView.h"
 
 class AudioDelayAudioProcessorEditor : public juce::AudioProcessorEditor
 {
@@ -17,9 +19,16 @@ public:
 
 private:
   void updateDelayKnob();
+  void renderBackground();
+
+  // Modulation matrix strip below the main grid
+  static const int MOD_STRIP_HEIGHT = 80;
 
   AudioDelayAudioProcessor &audioProcessor;
 
+  // Static backdrop, redrawn only when the editor is resized
+  juce::Image background;
+
   juce::ToggleButton lfoBitcrushSwitch;
   juce::ToggleButton lfoHighpassSwitch;
   juce::ToggleButton lfoLowpassSwitch;
@@ -59,10 +68,60 @@ private:
   juce::Label lfoPanLabel;
   juce::Label lfoDelayLabel;
 
+  juce::ToggleButton profilerSwitch;
+  ProfilerOverlay profilerOverlay;
+  ScopeView scopeView;
+
   juce::Slider smearKnob;
   juce::Label smearLabel;
   std::unique_ptr<juce::AudioProcessorValueTreeState::SliderAttachment> smearAttachment;
 
+  juce::Slider shimmerKnob;
+  juce::Label shimmerLabel;
+  juce::ComboBox shimmerPitchBox;
+  std::unique_ptr<juce::AudioProcessorValueTreeState::SliderAttachment> shimmerAttachment;
+  std::unique_ptr<juce::AudioProcessorValueTreeState::ComboBoxAttachment> shimmerPitchAttachment;
+
+  juce::Slider morphKnob;
+  juce::Label morphLabel;
+  juce::ToggleButton morphSwitch;
+  juce::TextButton storeMorphAButton;
+  juce::TextButton storeMorphBButton;
+  std::unique_ptr<juce::AudioProcessorValueTreeState::SliderAttachment> morphAttachment;
+  std::unique_ptr<juce::AudioProcessorValueTreeState::ButtonAttachment> morphEnabledAttachment;
+
+  juce::ToggleButton delayJumpSwitch;
+  std::unique_ptr<juce::AudioProcessorValueTreeState::ButtonAttachment> delayJumpAttachment;
+
+  std::array<juce::ComboBox, ModulationRoute::MAX_ROUTES> modSourceBoxes;
+  std::array<juce::ComboBox, ModulationRoute::MAX_ROUTES> modDestinationBoxes;
+  std::array<juce::Slider, ModulationRoute::MAX_ROUTES> modDepthSliders;
+  std::array<std::unique_ptr<juce::AudioProcessorValueTreeState::ComboBoxAttachment>, ModulationRoute::MAX_ROUTES> modSourceAttachments;
+  std::array<std::unique_ptr<juce::AudioProcessorValueTreeState::ComboBoxAttachment>, ModulationRoute::MAX_ROUTES> modDestinationAttachments;
+  std::array<std::unique_ptr<juce::AudioProcessorValueTreeState::SliderAttachment>, ModulationRoute::MAX_ROUTES> modDepthAttachments;
+  juce::Slider lfo2FreqSlider;
+  juce::Label lfo2FreqLabel;
+  std::unique_ptr<juce::AudioProcessorValueTreeState::SliderAttachment> lfo2FreqAttachment;
+
+  juce::ToggleButton reverseSwitch;
+  std::unique_ptr<juce::AudioProcessorValueTreeState::ButtonAttachment> reverseAttachment;
+
+  juce::ToggleButton freezeSwitch;
+  std::unique_ptr<juce::AudioProcessorValueTreeState::ButtonAttachment> freezeAttachment;
+
+  juce::ComboBox networkBox;
+  std::unique_ptr<juce::AudioProcessorValueTreeState::ComboBoxAttachment> networkAttachment;
+
+  juce::ComboBox filterSlopeBox;
+  std::unique_ptr<juce::AudioProcessorValueTreeState::ComboBoxAttachment> filterSlopeAttachment;
+
+  juce::ToggleButton spectralSwitch;
+  juce::ComboBox spectralHopBox;
+  juce::Slider spectralTiltSlider;
+  std::unique_ptr<juce::AudioProcessorValueTreeState::ButtonAttachment> spectralAttachment;
+  std::unique_ptr<juce::AudioProcessorValueTreeState::ComboBoxAttachment> spectralHopAttachment;
+  std::unique_ptr<juce::AudioProcessorValueTreeState::SliderAttachment> spectralTiltAttachment;
+
   std::unique_ptr<juce::AudioProcessorValueTreeState::ButtonAttachment> lfoBitcrushAttachment;
   std::unique_ptr<juce::AudioProcessorValueTreeState::ButtonAttachment> lfoHighpassAttachment;
   std::unique_ptr<juce::AudioProcessorValueTreeState::ButtonAttachment> lfoLowpassAttachment;
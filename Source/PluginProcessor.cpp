@@ -1,20 +1,13 @@
 #include "PluginProcessor.h"
 #include "PluginEditor.h"
-#include "LFOManager.h"
-#include "DelayManager.h"
 
 AudioDelayAudioProcessor::AudioDelayAudioProcessor()
     : AudioProcessor(BusesProperties()
                          .withInput("Input", juce::AudioChannelSet::stereo(), true)
                          .withOutput("Output", juce::AudioChannelSet::stereo(), true)),
       parameters(*this, nullptr, "Parameters", createParameterLayout()),
-      lastKnownBPM(120.0),
-      lfoManager(),
-      delayManager(),
-      chorusRate(1.0f),
-      chorusDepth(0.02f),
-      chorusPhase(0.0f),
-      chorusPhaseIncrement(0.0f)
+      presetBank(ParameterSnapshot::capture(parameters)),
+      lastKnownBPM(120.0)
 {
     DBG("AudioDelayAudioProcessor constructor called");
     delayParameter = parameters.getRawParameterValue("delay");
@@ -36,26 +29,41 @@ AudioDelayAudioProcessor::AudioDelayAudioProcessor()
     lfoTempoSyncParameter = parameters.getRawParameterValue("lfoTempoSync");
     lfoDelayParameter = parameters.getRawParameterValue("lfoDelay");
     waveshapeAmountParameter = parameters.getRawParameterValue("waveshapeAmount");
+    morphParameter = parameters.getRawParameterValue("morph");
+    morphEnabledParameter = parameters.getRawParameterValue("morphEnabled");
+    delayJumpParameter = parameters.getRawParameterValue("delayJump");
+    fdnLinesParameter = parameters.getRawParameterValue("fdnLines");
+    freezeParameter = parameters.getRawParameterValue("freeze");
+    shimmerParameter = parameters.getRawParameterValue("shimmer");
+    shimmerPitchParameter = parameters.getRawParameterValue("shimmerPitch");
+    reverseParameter = parameters.getRawParameterValue("reverse");
+    lfo2FreqParameter = parameters.getRawParameterValue("lfo2Freq");
+    filterSlopeParameter = parameters.getRawParameterValue("filterSlope");
+    spectralParameter = parameters.getRawParameterValue("spectral");
+    spectralHopParameter = parameters.getRawParameterValue("spectralHop");
+    spectralTiltParameter = parameters.getRawParameterValue("spectralTilt");
+    for (int slot = 0; slot < ModulationRoute::MAX_ROUTES; ++slot)
+    {
+        juce::String suffix(slot + 1);
+        modSourceParameters[static_cast<size_t>(slot)] = parameters.getRawParameterValue("modSource" + suffix);
+        modDestinationParameters[static_cast<size_t>(slot)] = parameters.getRawParameterValue("modDestination" + suffix);
+        modDepthParameters[static_cast<size_t>(slot)] = parameters.getRawParameterValue("modDepth" + suffix);
+    }
+
+    // Both morph end points start at the defaults until the user stores something
+    auto defaults = ParameterSnapshot::capture(parameters);
+    setMorphSnapshots(defaults, defaults);
 
     parameters.addParameterListener("tempoSync", this);
-    parameters.addParameterListener("delay", this);
     parameters.addParameterListener("lfoTempoSync", this);
     parameters.addParameterListener("lfoFreq", this);
 
-    waveShaper.functionToUse = [](float x)
-    {
-        return juce::jlimit(float(-0.1), float(0.1), x); // [6]
-    };
-
     DBG("AudioDelayAudioProcessor constructor completed");
 }
 
 AudioDelayAudioProcessor::~AudioDelayAudioProcessor()
 {
     parameters.removeParameterListener("tempoSync", this);
-    parameters.removeParameterListener("delay", this);
-    parameters.removeParameterListener("highpassFreq", this);
-    parameters.removeParameterListener("lowpassFreq", this);
     parameters.removeParameterListener("lfoTempoSync", this);
     parameters.removeParameterListener("lfoFreq", this);
 }
@@ -120,140 +128,90 @@ juce::AudioProcessorValueTreeState::ParameterLayout AudioDelayAudioProcessor::cr
 
     params.push_back(std::make_unique<juce::AudioParameterBool>("lfoDelay", "LFO Delay", false));
 
-    return {params.begin(), params.end()};
-}
+    // Morph between the stored A and B snapshots
+    params.push_back(std::make_unique<juce::AudioParameterFloat>("morph", "Morph", 0.0f, 1.0f, 0.0f));
+    params.push_back(std::make_unique<juce::AudioParameterBool>("morphEnabled", "Morph Enabled", false));
 
-void AudioDelayAudioProcessor::updateDelayTimeFromSync()
-{
-    int syncMode = static_cast<int>(tempoSyncParameter->load());
-    float currentDelayTime = delayParameter->load();
+    // Delay time changes crossfade between two read heads instead of gliding
+    params.push_back(std::make_unique<juce::AudioParameterBool>("delayJump", "Delay Jump", false));
 
-    if (syncMode != 0) // Not in Free mode
-    {
-        float syncedDelayTime = delayManager.updateDelayTimeFromSync(static_cast<float>(lastKnownBPM), syncMode);
+    // Single delay line, or a feedback delay network of 4, 8 or 16 lines
+    params.push_back(std::make_unique<juce::AudioParameterChoice>("fdnLines", "Feedback Network", juce::StringArray{"Single", "FDN 4", "FDN 8", "FDN 16"}, 0));
 
-        // Only update the knob value if in sync mode and we got a valid delay time
-        if (syncedDelayTime > 0.0f)
-        {
-            if (auto *param = parameters.getParameter("delay"))
-            {
-                float normalizedValue = param->convertTo0to1(syncedDelayTime);
-                param->setValueNotifyingHost(normalizedValue);
-            }
-        }
-    }
+    // Holds whatever is in the delay line as an endless loop
+    params.push_back(std::make_unique<juce::AudioParameterBool>("freeze", "Freeze", false));
 
-    // Always set the delay time from the knob value
-    float delayInSamples = currentDelayTime / 1000.0f * getSampleRate();
-    delayManager.setDelay(delayInSamples);
-}
-
-void AudioDelayAudioProcessor::updateDiffusionFilters()
-{
-    float smearAmount = smearParameter->load();
-    float sampleRate = static_cast<float>(getSampleRate());
+    // Pitch-shifted grains in the feedback loop
+    params.push_back(std::make_unique<juce::AudioParameterFloat>("shimmer", "Shimmer", 0.0f, 1.0f, 0.0f));
+    params.push_back(std::make_unique<juce::AudioParameterChoice>("shimmerPitch", "Shimmer Pitch", juce::StringArray{"-12", "+5", "+7", "+12"}, 3));
 
-    // Adjust diffusion curve: start medium, then decrease as smear increases
-    float diffusionCurve = 0.5f * (1.0f - std::pow(smearAmount, 0.5f));
+    // Repeats play backwards, one delay time at a time
+    params.push_back(std::make_unique<juce::AudioParameterBool>("reverse", "Reverse", false));
 
-    float delayTimes[4] = {0.0007f, 0.0011f, 0.0013f, 0.0017f}; // in seconds
-    float maxFeedbackAmounts[4] = {0.3f, 0.35f, 0.4f, 0.45f};   // Maximum feedback amounts
+    // Modulation matrix: a second LFO, and routes from any source to any continuous parameter
+    params.push_back(std::make_unique<juce::AudioParameterFloat>("lfo2Freq", "LFO 2 Frequency", 0.01f, 20.0f, 0.5f));
 
-    for (size_t i = 0; i < 4; ++i)
+    juce::StringArray modSources = {"Off", "LFO 1", "LFO 2", "Envelope"};
+    juce::StringArray modDestinations = {"Delay", "Feedback", "Mix", "Bitcrush", "Stereo Width", "Pan", "Highpass", "Lowpass", "Shimmer"};
+    for (int slot = 1; slot <= ModulationRoute::MAX_ROUTES; ++slot)
     {
-        float delayTime = juce::jmax(0.00001f, delayTimes[i]);
-        float feedback = maxFeedbackAmounts[i] * diffusionCurve;
-
-        float frequency = juce::jlimit(20.0f, sampleRate * 0.49f, 1.0f / delayTime);
-        float q = juce::jlimit(0.01f, 10.0f, 1.0f / (2.0f * (1.0f - feedback))); // Reduced maximum Q
-
-        diffusionFilters[i].setCutoffFrequency(frequency);
-        diffusionFilters[i].setResonance(q);
+        juce::String suffix(slot);
+        params.push_back(std::make_unique<juce::AudioParameterChoice>("modSource" + suffix, "Mod " + suffix + " Source", modSources, 0));
+        params.push_back(std::make_unique<juce::AudioParameterChoice>("modDestination" + suffix, "Mod " + suffix + " Destination", modDestinations, 0));
+        params.push_back(std::make_unique<juce::AudioParameterFloat>("modDepth" + suffix, "Mod " + suffix + " Depth", -1.0f, 1.0f, 0.0f));
     }
 
-    // Update pre and post diffusion lowpass filters
-    float lowpassFreq = juce::jmap(smearAmount, 20000.0f, 10000.0f);
-    preDiffusionLowpass.setCutoffFrequency(lowpassFreq);
-    postDiffusionLowpass.setCutoffFrequency(lowpassFreq);
-
-    // Update chorus parameters
-    if (smearAmount > 0.0f)
-    {
-        // Slower increase in chorus rate
-        chorusRate = 0.2f + smearAmount * 0.8f; // Chorus rate from 0.2 Hz to 1.0 Hz
-
-        // More subtle increase in chorus depth
-        chorusDepth = std::pow(smearAmount, 1.5f) * 0.005f; // Non-linear increase, up to 5 ms
-
-        chorusPhaseIncrement = (chorusRate * juce::MathConstants<float>::twoPi) / sampleRate;
-
-        // Update chorus lowpass filter
-        float chorusCutoff = juce::jmap(smearAmount, 10000.0f, 15000.0f);
-        *chorusLowpass.coefficients = *juce::dsp::IIR::Coefficients<float>::makeLowPass(sampleRate, chorusCutoff);
+    // Slope of both wet filters; added last so existing parameter indices don't move
+    params.push_back(std::make_unique<juce::AudioParameterChoice>("filterSlope", "Filter Slope", juce::StringArray{"12 dB/oct", "24 dB/oct", "36 dB/oct", "48 dB/oct"}, 0));
 
-        DBG("Chorus parameters updated - Rate: " << chorusRate << " Hz, Depth: " << chorusDepth << ", Cutoff: " << chorusCutoff << " Hz");
-    }
-    else
-    {
-        chorusRate = 0.0f;
-        chorusDepth = 0.0f;
-        chorusPhaseIncrement = 0.0f;
-        DBG("Chorus disabled");
-    }
+    // Spectral mode: STFT delay with per-band times, hop in samples (latency is four hops)
+    params.push_back(std::make_unique<juce::AudioParameterBool>("spectral", "Spectral Mode", false));
+    params.push_back(std::make_unique<juce::AudioParameterChoice>("spectralHop", "Spectral Hop", juce::StringArray{"128", "256", "512", "1024"}, 1));
+    params.push_back(std::make_unique<juce::AudioParameterFloat>("spectralTilt", "Spectral Tilt", -1.0f, 1.0f, 0.0f));
 
-    DBG("Diffusion filters updated - Smear Amount: " << smearAmount
-                                                     << ", Diffusion Curve: " << diffusionCurve
-                                                     << ", Pre/Post Lowpass Freq: " << lowpassFreq
-                                                     << ", Diffusion Filter 0 Freq: " << diffusionFilters[0].getCutoffFrequency()
-                                                     << ", Q: " << diffusionFilters[0].getResonance());
+    return {params.begin(), params.end()};
 }
 
-float AudioDelayAudioProcessor::processDiffusionFilters(float input, int channel)
+float AudioDelayAudioProcessor::getSyncedDelayTime(int syncMode)
 {
-    float smearAmount = smearParameter->load();
+    auto bpm = static_cast<float>(lastKnownBPM);
+    if (doubleEngine != nullptr)
+        return doubleEngine->getDelayManager().updateDelayTimeFromSync(bpm, syncMode);
+    if (floatEngine != nullptr)
+        return floatEngine->getDelayManager().updateDelayTimeFromSync(bpm, syncMode);
+    return 0.0f;
+}
 
-    if (smearAmount <= 0.0f)
-    {
-        return input;
-    }
+float AudioDelayAudioProcessor::getSyncedLFOFrequency(int syncMode)
+{
+    auto bpm = static_cast<float>(lastKnownBPM);
+    if (doubleEngine != nullptr)
+        return doubleEngine->getLFOManager().updateFrequencyFromSync(bpm, syncMode);
+    if (floatEngine != nullptr)
+        return floatEngine->getLFOManager().updateFrequencyFromSync(bpm, syncMode);
+    return 0.0f;
+}
 
-    float output = preDiffusionLowpass.processSample(channel, input);
+void AudioDelayAudioProcessor::updateDelayTimeFromSync()
+{
+    int syncMode = static_cast<int>(tempoSyncParameter->load());
 
-    // Improved chorus effect
-    float chorusModulation = chorusDepth * (std::sin(chorusPhase + (channel * juce::MathConstants<float>::pi * 0.5f)) * 0.5f + 0.5f);
-    if (channel == 0)
+    if (syncMode != 0) // Not in Free mode
     {
-        chorusPhase += chorusPhaseIncrement;
-        if (chorusPhase >= juce::MathConstants<float>::twoPi)
-            chorusPhase -= juce::MathConstants<float>::twoPi;
-    }
-
-    // Use smoother interpolation for chorus
-    float delayInSamples = chorusModulation * getSampleRate();
-    float chorusOutput = chorusDelayLine.popSample(channel, delayInSamples, true); // Use internal interpolation
-
-    chorusDelayLine.pushSample(channel, input);
+        float syncedDelayTime = getSyncedDelayTime(syncMode);
 
-    // Apply lowpass filter to chorus output
-    chorusOutput = chorusLowpass.processSample(chorusOutput);
-
-    // Diffusion processing with smoother parameter changes
-    for (size_t i = 0; i < diffusionFilters.size(); ++i)
-    {
-        float modulatedFrequency = diffusionFilters[i].getCutoffFrequency() * (1.0f + chorusModulation * 0.1f);
-        diffusionFilters[i].setCutoffFrequency(modulatedFrequency);
-        output = diffusionFilters[i].processSample(channel, output);
+        // Only update the knob value if in sync mode and we got a valid delay time
+        if (syncedDelayTime > 0.0f)
+        {
+            if (auto *param = parameters.getParameter("delay"))
+            {
+                float normalizedValue = param->convertTo0to1(syncedDelayTime);
+                param->setValueNotifyingHost(normalizedValue);
+            }
+        }
     }
 
-    output = postDiffusionLowpass.processSample(channel, output);
-
-    // Smooth mixing of dry, chorus, and diffused signals
-    float wetAmount = smearAmount;
-    float dryAmount = 1.0f - wetAmount;
-
-    float mixedOutput = input * dryAmount + (chorusOutput * 0.6f + output * 0.4f) * wetAmount;
-
-    return mixedOutput;
+    // The engine picks the delay time up from the knob value on its next block
 }
 
 void AudioDelayAudioProcessor::prepareToPlay(double sampleRate, int samplesPerBlock)
@@ -263,375 +221,248 @@ void AudioDelayAudioProcessor::prepareToPlay(double sampleRate, int samplesPerBl
     spec.maximumBlockSize = static_cast<juce::uint32>(samplesPerBlock);
     spec.numChannels = static_cast<juce::uint32>(getTotalNumOutputChannels());
 
-    chorusDelayLine.prepare(spec);
-    chorusDelayLine.setMaximumDelayInSamples(getSampleRate() * 0.05f + 3); // 50 ms + 3 samples for cubic interpolation
-
-    chorusLowpass.prepare(spec);
-    chorusLowpass.coefficients = juce::dsp::IIR::Coefficients<float>::makeLowPass(sampleRate, 10000.0f);
-
-    convolution.prepare(spec);
-    waveShaper.prepare(spec);
-
-    delayManager.prepare(spec);
-    dryWetMixer.prepare(spec);
-    panner.prepare(spec);
+    refreshMorphSnapshots();
 
-    highpassFilter.prepare(spec);
-    lowpassFilter.prepare(spec);
+    // About 2 seconds of history across the editor's scope
+    scopeFifo.prepare(sampleRate, 0.008);
 
-    lfoManager.prepare(spec);
-    lfoManager.setFrequency(lfoFreqParameter->load());
-
-    for (auto &filter : diffusionFilters)
+    // Only the engine matching the host's processing precision holds any memory
+    if (isUsingDoublePrecision())
     {
-        filter.prepare(spec);
-        filter.setType(juce::dsp::StateVariableTPTFilterType::bandpass);
-        filter.setResonance(0.7f);
-        filter.setCutoffFrequency(1000.0f); // Set a default cutoff frequency
+        floatEngine.reset();
+        doubleEngine = std::make_unique<DelayEngine<double>>();
+        doubleEngine->setProfiler(&profiler);
+        doubleEngine->setScope(&scopeFifo);
+        doubleEngine->prepare(spec, takeParameterSnapshot());
+        setLatencySamples(doubleEngine->getLatencySamples());
     }
-    preDiffusionLowpass.prepare(spec);
-    preDiffusionLowpass.setType(juce::dsp::StateVariableTPTFilterType::lowpass);
-    preDiffusionLowpass.setCutoffFrequency(10000.0f);
-
-    postDiffusionLowpass.prepare(spec);
-    postDiffusionLowpass.setType(juce::dsp::StateVariableTPTFilterType::lowpass);
-    postDiffusionLowpass.setCutoffFrequency(10000.0f);
-
-    for (auto &filter : dcBlocker)
-    {
-        filter.prepare(spec);
-        filter.coefficients = juce::dsp::IIR::Coefficients<float>::makeHighPass(sampleRate, 20.0f);
-    }
-
-    for (auto &filter : finalDCBlocker)
+    else
     {
-        filter.prepare(spec);
-        filter.coefficients = juce::dsp::IIR::Coefficients<float>::makeHighPass(sampleRate, 5.0f);
+        doubleEngine.reset();
+        floatEngine = std::make_unique<DelayEngine<float>>();
+        floatEngine->setProfiler(&profiler);
+        floatEngine->setScope(&scopeFifo);
+        floatEngine->prepare(spec, takeParameterSnapshot());
+        setLatencySamples(floatEngine->getLatencySamples());
     }
 
-    chorusPhaseIncrement = (chorusRate * juce::MathConstants<float>::twoPi) / static_cast<float>(sampleRate);
-
     updateLFOFrequency();
-    updateDiffusionFilters();
     updateDelayTimeFromSync();
-    updateFilterParameters();
-
-    // Initialize the delay time after the delayManager has been prepared
-    float delayTime = delayParameter->load();
-    float delayInSamples = delayTime / 1000.0f * sampleRate;
-    delayManager.setDelay(delayInSamples);
 }
 
-void AudioDelayAudioProcessor::processBlock(juce::AudioBuffer<float> &buffer, juce::MidiBuffer &midiMessages)
-{
-    juce::ScopedNoDenormals noDenormals;
-    auto totalNumInputChannels = getTotalNumInputChannels();
-    auto totalNumOutputChannels = getTotalNumOutputChannels();
-
-    DBG("-------- processBlock start --------");
-    DBG("Buffer size: " << buffer.getNumSamples() << ", Input channels: " << totalNumInputChannels << ", Output channels: " << totalNumOutputChannels);
-
-    float currentLFOFreq = lfoFreqParameter->load();
-    DBG("Current LFO Frequency: " << currentLFOFreq << " Hz");
-
-    float bitcrushAmount = bitcrushParameter->load();
-    float waveshapeAmount = waveshapeAmountParameter->load();
-
-    lfoManager.setFrequency(currentLFOFreq);
-    lfoManager.generateBlock(buffer.getNumSamples());
-
-    DBG("LFO block generated. Checking samples:");
-    DBG("First LFO sample: " << lfoManager.getSample(0));
-    DBG("Middle LFO sample: " << lfoManager.getSample(buffer.getNumSamples() / 2));
-    DBG("Last LFO sample: " << lfoManager.getSample(buffer.getNumSamples() - 1));
-
-    // Clear any output channels that don't contain input data
-    for (auto i = totalNumInputChannels; i < totalNumOutputChannels; ++i)
-        buffer.clear(i, 0, buffer.getNumSamples());
-
-    DBG("Updating BPM if changed");
-    updateBPMIfChanged();
-
-    // Prepare dry and wet buffers
-    juce::AudioBuffer<float> dryBuffer(buffer);
-    juce::AudioBuffer<float> wetBuffer(totalNumInputChannels, buffer.getNumSamples());
-
-    // Get current parameter values
-    float feedback = feedbackParameter->load();
-    float mix = mixParameter->load();
-    float stereoWidth = stereoWidthParameter->load();
-    float pan = panParameter->load();
-    float lfoAmount = lfoAmountParameter->load();
-    float smearAmount = smearParameter->load();
-
-    DBG("Current parameters - Feedback: " << feedback << ", Mix: " << mix << ", Bitcrush: " << bitcrushAmount
-                                          << ", Stereo Width: " << stereoWidth << ", Pan: " << pan << ", LFO Amount: " << lfoAmount << ", Smear: " << smearAmount);
-
-    DBG("Updating diffusion filters");
-    updateDiffusionFilters();
-
-    DBG("Processing delay and effects");
-    // Process delay and apply effects
-    for (int channel = 0; channel < totalNumInputChannels; ++channel)
-    {
-        auto *inputData = buffer.getReadPointer(channel);
-        auto *wetData = wetBuffer.getWritePointer(channel);
-
-        for (int sample = 0; sample < buffer.getNumSamples(); ++sample)
-        {
-            processDelayAndEffects(channel, sample, inputData, wetData, feedback, bitcrushAmount, smearAmount, lfoAmount, waveshapeAmount);
-        }
+DelayParameters AudioDelayAudioProcessor::takeParameterSnapshot() const
+{
+    // While morphing, the engine follows the A/B blend and the individual knobs are ignored
+    if (morphEnabledParameter->load() > 0.5f)
+        return toDelayParameters(ParameterSnapshot::interpolate(audioMorphSnapshots[0], audioMorphSnapshots[1], morphParameter->load()));
+
+    DelayParameters params;
+    params.delay = delayParameter->load();
+    params.feedback = feedbackParameter->load();
+    params.mix = mixParameter->load();
+    params.bitcrush = bitcrushParameter->load();
+    params.stereoWidth = stereoWidthParameter->load();
+    params.pan = panParameter->load();
+    params.highpassFreq = highpassFreqParameter->load();
+    params.lowpassFreq = lowpassFreqParameter->load();
+    params.lfoFreq = lfoFreqParameter->load();
+    params.lfoAmount = lfoAmountParameter->load();
+    params.smear = smearParameter->load();
+    params.waveshapeAmount = waveshapeAmountParameter->load();
+    params.lfoBitcrush = lfoBitcrushParameter->load() > 0.5f;
+    params.lfoHighpass = lfoHighpassParameter->load() > 0.5f;
+    params.lfoLowpass = lfoLowpassParameter->load() > 0.5f;
+    params.lfoPan = lfoPanParameter->load() > 0.5f;
+    params.lfoDelay = lfoDelayParameter->load() > 0.5f;
+    params.delayJump = delayJumpParameter->load() > 0.5f;
+    params.fdnLines = getNetworkLineCount(fdnLinesParameter->load());
+    params.freeze = freezeParameter->load() > 0.5f;
+    params.shimmer = shimmerParameter->load();
+    params.shimmerPitch = getShimmerSemitones(shimmerPitchParameter->load());
+    params.reverse = reverseParameter->load() > 0.5f;
+    params.lfo2Freq = lfo2FreqParameter->load();
+    params.filterSlope = getFilterSlope(filterSlopeParameter->load());
+    params.spectral = spectralParameter->load() > 0.5f;
+    params.spectralHop = getSpectralHop(spectralHopParameter->load());
+    params.spectralTilt = spectralTiltParameter->load();
+    for (size_t slot = 0; slot < params.modRoutes.size(); ++slot)
+    {
+        params.modRoutes[slot].source = juce::roundToInt(modSourceParameters[slot]->load());
+        params.modRoutes[slot].destination = juce::roundToInt(modDestinationParameters[slot]->load());
+        params.modRoutes[slot].depth = modDepthParameters[slot]->load();
     }
-
-    DBG("Applying filters to wet signal");
-    applyFiltersToWetSignal(wetBuffer);
-
-    DBG("Applying stereo width");
-    applyStereoWidth(wetBuffer, stereoWidth);
-
-    DBG("Applying panning");
-    applyPanning(wetBuffer, pan, lfoAmount);
-
-    DBG("Mixing dry and wet signals");
-    mixDryWetSignals(buffer, dryBuffer, wetBuffer, mix);
-
-    DBG("Applying final DC blocking");
-    applyFinalDCBlocking(buffer);
-
-    juce::ignoreUnused(midiMessages);
-
-    DBG("-------- processBlock end --------");
+    return params;
+}
+
+DelayParameters AudioDelayAudioProcessor::toDelayParameters(const ParameterSnapshot &snapshot)
+{
+    DelayParameters params;
+    params.delay = snapshot[ParameterSnapshot::Delay];
+    params.feedback = snapshot[ParameterSnapshot::Feedback];
+    params.mix = snapshot[ParameterSnapshot::Mix];
+    params.bitcrush = snapshot[ParameterSnapshot::Bitcrush];
+    params.stereoWidth = snapshot[ParameterSnapshot::StereoWidth];
+    params.pan = snapshot[ParameterSnapshot::Pan];
+    params.highpassFreq = snapshot[ParameterSnapshot::HighpassFreq];
+    params.lowpassFreq = snapshot[ParameterSnapshot::LowpassFreq];
+    params.lfoFreq = snapshot[ParameterSnapshot::LFOFreq];
+    params.lfoAmount = snapshot[ParameterSnapshot::LFOAmount];
+    params.smear = snapshot[ParameterSnapshot::Smear];
+    params.waveshapeAmount = snapshot[ParameterSnapshot::WaveshapeAmount];
+    params.lfoBitcrush = snapshot[ParameterSnapshot::LFOBitcrush] > 0.5f;
+    params.lfoHighpass = snapshot[ParameterSnapshot::LFOHighpass] > 0.5f;
+    params.lfoLowpass = snapshot[ParameterSnapshot::LFOLowpass] > 0.5f;
+    params.lfoPan = snapshot[ParameterSnapshot::LFOPan] > 0.5f;
+    params.lfoDelay = snapshot[ParameterSnapshot::LFODelay] > 0.5f;
+    params.delayJump = snapshot[ParameterSnapshot::DelayJump] > 0.5f;
+    params.fdnLines = getNetworkLineCount(snapshot[ParameterSnapshot::FDNLines]);
+    params.freeze = snapshot[ParameterSnapshot::Freeze] > 0.5f;
+    params.shimmer = snapshot[ParameterSnapshot::Shimmer];
+    params.shimmerPitch = getShimmerSemitones(snapshot[ParameterSnapshot::ShimmerPitch]);
+    params.reverse = snapshot[ParameterSnapshot::Reverse] > 0.5f;
+    params.lfo2Freq = snapshot[ParameterSnapshot::LFO2Freq];
+    params.filterSlope = getFilterSlope(snapshot[ParameterSnapshot::FilterSlope]);
+    params.spectral = snapshot[ParameterSnapshot::Spectral] > 0.5f;
+    params.spectralHop = getSpectralHop(snapshot[ParameterSnapshot::SpectralHop]);
+    params.spectralTilt = snapshot[ParameterSnapshot::SpectralTilt];
+    for (int slot = 0; slot < ModulationRoute::MAX_ROUTES; ++slot)
+    {
+        auto &route = params.modRoutes[static_cast<size_t>(slot)];
+        int first = ParameterSnapshot::ModSource1 + slot * ParameterSnapshot::PARAMETERS_PER_ROUTE;
+        route.source = juce::roundToInt(snapshot[first]);
+        route.destination = juce::roundToInt(snapshot[first + 1]);
+        route.depth = snapshot[first + 2];
+    }
+    return params;
 }
 
-void AudioDelayAudioProcessor::applyPanning(juce::AudioBuffer<float> &buffer, float pan, float lfoAmount)
+int AudioDelayAudioProcessor::getNetworkLineCount(float choiceIndex)
 {
-    for (int sample = 0; sample < buffer.getNumSamples(); ++sample)
-    {
-        float lfoValue = lfoManager.getSample(sample);
-        float modifiedPan = pan;
-
-        if (lfoPanParameter->load() > 0.5f)
-        {
-            modifiedPan = applyLFOToPan(pan, lfoAmount, lfoValue);
-        }
-
-        // Convert pan [-1, 1] to gain [0, 1] for each channel
-        float leftGain = 0.5f * (1.0f - modifiedPan);
-        float rightGain = 0.5f * (1.0f + modifiedPan);
-
-        buffer.setSample(0, sample, buffer.getSample(0, sample) * leftGain);
-        buffer.setSample(1, sample, buffer.getSample(1, sample) * rightGain);
-    }
+    static const int lineCounts[] = {0, 4, 8, 16};
+    return lineCounts[juce::jlimit(0, 3, juce::roundToInt(choiceIndex))];
 }
 
-void AudioDelayAudioProcessor::applyStereoWidth(juce::AudioBuffer<float> &buffer, float width)
+float AudioDelayAudioProcessor::getShimmerSemitones(float choiceIndex)
 {
-    if (buffer.getNumChannels() < 2)
-        return;
-
-    float *left = buffer.getWritePointer(0);
-    float *right = buffer.getWritePointer(1);
-
-    for (int sample = 0; sample < buffer.getNumSamples(); ++sample)
-    {
-        float mid = (left[sample] + right[sample]) * 0.5f;
-        float side = (right[sample] - left[sample]) * 0.5f;
-
-        left[sample] = mid - side * width;
-        right[sample] = mid + side * width;
-    }
+    static const float semitones[] = {-12.0f, 5.0f, 7.0f, 12.0f};
+    return semitones[juce::jlimit(0, 3, juce::roundToInt(choiceIndex))];
 }
 
-void AudioDelayAudioProcessor::mixDryWetSignals(juce::AudioBuffer<float> &buffer, const juce::AudioBuffer<float> &dryBuffer, const juce::AudioBuffer<float> &wetBuffer, float mix)
+int AudioDelayAudioProcessor::getFilterSlope(float choiceIndex)
 {
-    for (int channel = 0; channel < buffer.getNumChannels(); ++channel)
-    {
-        auto *outputData = buffer.getWritePointer(channel);
-        auto *dryData = dryBuffer.getReadPointer(channel);
-        auto *wetData = wetBuffer.getReadPointer(channel);
-
-        for (int sample = 0; sample < buffer.getNumSamples(); ++sample)
-        {
-            outputData[sample] = dryData[sample] * (1 - mix) + wetData[sample] * mix;
-        }
-    }
+    return 12 * (juce::jlimit(0, 3, juce::roundToInt(choiceIndex)) + 1);
 }
 
-void AudioDelayAudioProcessor::applyLFOToFilters(float smoothedLFO, float lfoAmount)
+int AudioDelayAudioProcessor::getSpectralHop(float choiceIndex)
 {
-    float baseHighpassFreq = highpassFreqParameter->load();
-    float baseLowpassFreq = lowpassFreqParameter->load();
-    float modifiedHighpassFreq = baseHighpassFreq;
-    float modifiedLowpassFreq = baseLowpassFreq;
+    return 128 << juce::jlimit(0, 3, juce::roundToInt(choiceIndex));
+}
 
-    if (lfoHighpassParameter->load() > 0.5f)
-    {
-        // Increase the modulation range for highpass
-        float highpassModDepth = juce::jmap(lfoAmount, 0.5f, 6.0f);
-        modifiedHighpassFreq = juce::jlimit(
-            20.0f,
-            5000.0f,
-            baseHighpassFreq * std::pow(2.0f, highpassModDepth * (smoothedLFO * 2.0f - 1.0f)));
-    }
+void AudioDelayAudioProcessor::storeMorphSnapshot(int slot)
+{
+    if (!juce::isPositiveAndBelow(slot, 2))
+        return;
 
-    if (lfoLowpassParameter->load() > 0.5f)
+    auto snapshot = ParameterSnapshot::capture(parameters);
     {
-        // Increase the modulation range for lowpass
-        float lowpassModDepth = juce::jmap(lfoAmount, 0.5f, 4.0f);
-        modifiedLowpassFreq = juce::jlimit(
-            200.0f,
-            20000.0f,
-            baseLowpassFreq * std::pow(2.0f, lowpassModDepth * (smoothedLFO * 2.0f - 1.0f)));
+        const juce::SpinLock::ScopedLockType lock(morphLock);
+        morphSnapshots[static_cast<size_t>(slot)] = snapshot;
     }
-
-    *highpassFilter.state = *juce::dsp::IIR::Coefficients<float>::makeHighPass(getSampleRate(), modifiedHighpassFreq);
-    *lowpassFilter.state = *juce::dsp::IIR::Coefficients<float>::makeLowPass(getSampleRate(), modifiedLowpassFreq);
-}
-
-void AudioDelayAudioProcessor::updateChorusPhase()
-{
-    chorusPhase += chorusPhaseIncrement;
-    if (chorusPhase >= juce::MathConstants<float>::twoPi)
-        chorusPhase -= juce::MathConstants<float>::twoPi;
+    morphSnapshotsChanged.store(true);
 }
 
-float AudioDelayAudioProcessor::applyLFOToBitcrush(float bitcrushAmount, float lfoAmount, float smoothedLFO)
+void AudioDelayAudioProcessor::setMorphSnapshots(const ParameterSnapshot &a, const ParameterSnapshot &b)
 {
-    if (lfoBitcrushParameter->load() > 0.5f)
     {
-        return applyLFO(bitcrushAmount, lfoAmount, smoothedLFO, 1.0f, 16.0f);
+        const juce::SpinLock::ScopedLockType lock(morphLock);
+        morphSnapshots[0] = a;
+        morphSnapshots[1] = b;
     }
-    return bitcrushAmount;
+    morphSnapshotsChanged.store(true);
 }
 
-float AudioDelayAudioProcessor::processDelaySample(int channel, float delayInSamples, float smearAmount, float lfoModulation)
+void AudioDelayAudioProcessor::refreshMorphSnapshots()
 {
-    // Apply LFO modulation to delay time
-    float lfoModulatedDelay = delayInSamples * (1.0f + lfoModulation);
-
-    // Apply additional chorusing based on smear amount
-    float chorusModulation = chorusDepth * std::sin(chorusPhase) * smearAmount;
-    float totalModulatedDelay = lfoModulatedDelay * (1.0f + chorusModulation);
-
-    // Get the delayed sample
-    float delaySample = delayManager.popSample(channel, totalModulatedDelay);
+    if (!morphSnapshotsChanged.load())
+        return;
 
-    // Apply diffusion if smear is active
-    if (smearAmount > 0.0f)
+    // Never wait on the message thread; if it holds the lock, pick the change up next block
+    const juce::SpinLock::ScopedTryLockType lock(morphLock);
+    if (lock.isLocked())
     {
-        float diffusedSample = processDiffusionFilters(delaySample, channel);
-        delaySample = juce::jmap(smearAmount, delaySample, diffusedSample);
+        audioMorphSnapshots = morphSnapshots;
+        morphSnapshotsChanged.store(false);
     }
-
-    return delaySample;
 }
 
-void AudioDelayAudioProcessor::applyFinalDCBlocking(juce::AudioBuffer<float> &buffer)
+void AudioDelayAudioProcessor::processBlock(juce::AudioBuffer<float> &buffer, juce::MidiBuffer &midiMessages)
 {
-    for (int channel = 0; channel < buffer.getNumChannels(); ++channel)
-    {
-        auto *channelData = buffer.getWritePointer(channel);
-        for (int sample = 0; sample < buffer.getNumSamples(); ++sample)
-        {
-            channelData[sample] = finalDCBlocker[static_cast<size_t>(channel)].processSample(channelData[sample]);
-        }
-    }
+    juce::ignoreUnused(midiMessages);
+    jassert(floatEngine != nullptr);
+    if (floatEngine != nullptr)
+        processSamples(buffer, *floatEngine);
 }
 
-void AudioDelayAudioProcessor::applyFiltersToWetSignal(juce::AudioBuffer<float> &wetBuffer)
+void AudioDelayAudioProcessor::processBlock(juce::AudioBuffer<double> &buffer, juce::MidiBuffer &midiMessages)
 {
-    juce::dsp::AudioBlock<float> wetBlock(wetBuffer);
-    juce::dsp::ProcessContextReplacing<float> wetContext(wetBlock);
-    highpassFilter.process(wetContext);
-    lowpassFilter.process(wetContext);
+    juce::ignoreUnused(midiMessages);
+    jassert(doubleEngine != nullptr);
+    if (doubleEngine != nullptr)
+        processSamples(buffer, *doubleEngine);
 }
 
-void AudioDelayAudioProcessor::processDelayAndEffects(int channel, int sample, const float *inputData, float *wetData, float feedback, float bitcrushAmount, float smearAmount, float lfoAmount, float waveshapeAmount)
+bool AudioDelayAudioProcessor::supportsDoublePrecisionProcessing() const
 {
-    float smoothedLFO = lfoManager.getSample(sample);
-
-    // Apply a global LFO depth control
-    float globalLFODepth = 1.5f; // Adjust this value to increase overall LFO impact
-    float enhancedLFOAmount = lfoAmount * globalLFODepth;
-
-    applyLFOToFilters(smoothedLFO, enhancedLFOAmount);
-
-    float modifiedBitcrush = applyLFOToBitcrush(bitcrushAmount, enhancedLFOAmount, smoothedLFO);
-
-    float delayTime = delayParameter->load();
-    float delayInSamples = delayTime / 1000.0f * getSampleRate();
+    return true;
+}
 
-    // Get the input sample
-    float inputSample = inputData[sample];
+template <typename SampleType>
+void AudioDelayAudioProcessor::processSamples(juce::AudioBuffer<SampleType> &buffer, DelayEngine<SampleType> &engine)
+{
+    juce::ScopedNoDenormals noDenormals;
+    StageProfiler::ScopedTimer blockTimer(&profiler, StageProfiler::WholeBlock);
+    auto totalNumInputChannels = getTotalNumInputChannels();
+    auto totalNumOutputChannels = getTotalNumOutputChannels();
+    auto numSamples = buffer.getNumSamples();
 
-    // Calculate LFO modulation for delay
-    float lfoModulation = 0.0f;
-    if (lfoDelayParameter->load() > 0.5f)
-    {
-        lfoModulation = smoothedLFO * enhancedLFOAmount * 0.2f;
-    }
+    DBG("-------- processBlock start --------");
+    DBG("Buffer size: " << numSamples << ", Input channels: " << totalNumInputChannels << ", Output channels: " << totalNumOutputChannels);
 
-    // Process delay sample with both LFO modulation and smear
-    float delaySample = processDelaySample(channel, delayInSamples, smearAmount, lfoModulation);
+    // Clear any output channels that don't contain input data
+    for (auto i = totalNumInputChannels; i < totalNumOutputChannels; ++i)
+        buffer.clear(i, 0, numSamples);
 
-    // Apply smear (diffusion and chorus) to the delayed signal
-    delaySample = processDiffusionFilters(delaySample, channel);
+    DBG("Updating BPM if changed");
+    updateBPMIfChanged();
 
-    // Apply bitcrushing to the delayed signal
-    if (modifiedBitcrush < 16.0f)
-    {
-        delaySample = applyBitcrushing(delaySample, modifiedBitcrush, waveshapeAmount);
-    }
+    refreshMorphSnapshots();
+    const auto params = takeParameterSnapshot();
 
-    // Apply DC blocking filter to the delayed sample
-    delaySample = dcBlocker[static_cast<size_t>(channel)].processSample(delaySample);
+    DBG("Current parameters - Feedback: " << params.feedback << ", Mix: " << params.mix << ", Bitcrush: " << params.bitcrush
+                                          << ", Stereo Width: " << params.stereoWidth << ", Pan: " << params.pan
+                                          << ", LFO Amount: " << params.lfoAmount << ", Smear: " << params.smear);
 
-    delayManager.pushSample(channel, inputSample + (delaySample * feedback));
-    wetData[sample] = delaySample;
+    engine.process(buffer, totalNumInputChannels, params);
 
-    updateChorusPhase();
+    // Spectral mode and its hop move the latency; the host hears about it as soon as the engine does
+    if (engine.getLatencySamples() != getLatencySamples())
+        setLatencySamples(engine.getLatencySamples());
 
-    // Debug output (if needed)
-    if (sample == 0)
-    {
-        DBG("Channel " << channel << " - Sample 0:");
-        DBG("  Input: " << inputSample << ", Output: " << delaySample);
-        DBG("  LFO: " << smoothedLFO << ", Enhanced Amount: " << enhancedLFOAmount);
-        DBG("  Smear Amount: " << smearAmount << ", LFO Modulation: " << lfoModulation);
-    }
+    DBG("-------- processBlock end --------");
 }
 
 void AudioDelayAudioProcessor::parameterChanged(const juce::String &parameterID, float newValue)
 {
+    juce::ignoreUnused(newValue);
 
-    if (parameterID == "delay")
-    {
-        float delayInSamples = newValue / 1000.0f * getSampleRate();
-        delayManager.setDelay(delayInSamples);
-    }
-    else if (parameterID == "tempoSync")
+    if (parameterID == "tempoSync")
     {
         updateDelayTimeFromSync();
     }
-    if (parameterID == "smear")
-    {
-        updateDiffusionFilters();
-    }
-    else if (parameterID == "lfoTempoSync")
+    else if (parameterID == "lfoTempoSync" || parameterID == "lfoFreq")
     {
         updateLFOFrequency();
     }
-    else if (parameterID == "lfoFreq")
-    {
-        lfoManager.setFrequency(newValue);
-        updateLFOFrequency();
-    }
-    else if (parameterID == "highpassFreq" || parameterID == "lowpassFreq" ||
-             parameterID == "lfoHighpass" || parameterID == "lfoLowpass" ||
-             parameterID == "lfoAmount")
-    {
-        updateFilterParameters();
-    }
 }
 
 void AudioDelayAudioProcessor::updateLFOFrequency()
@@ -641,7 +472,7 @@ void AudioDelayAudioProcessor::updateLFOFrequency()
 
     if (syncMode != 0) // Not in Free mode
     {
-        float syncedFreq = lfoManager.updateFrequencyFromSync(static_cast<float>(lastKnownBPM), syncMode);
+        float syncedFreq = getSyncedLFOFrequency(syncMode);
 
         // Only update the knob value if in sync mode
         if (syncedFreq > 0.0f)
@@ -654,8 +485,7 @@ void AudioDelayAudioProcessor::updateLFOFrequency()
         }
     }
 
-    // Always set the LFO frequency from the knob value
-    lfoManager.setFrequency(lfoFreqParameter->load());
+    // The engine picks the LFO frequency up from the knob value on its next block
 }
 
 void AudioDelayAudioProcessor::updateBPMIfChanged()
@@ -685,63 +515,6 @@ void AudioDelayAudioProcessor::timerCallback()
     updateDelayTimeFromSync();
 }
 
-void AudioDelayAudioProcessor::updateFilterParameters()
-{
-    float lfoAmount = lfoAmountParameter->load();
-
-    // We can't use a specific sample index here, so we'll use the middle of the buffer
-    int middleSample = lfoManager.getBufferSize() / 2;
-    float smoothedLFO = lfoManager.getSample(middleSample);
-
-    applyLFOToFilters(smoothedLFO, lfoAmount);
-}
-
-float AudioDelayAudioProcessor::applyBitcrushing(float sample, float bitcrushAmount, float waveshapeAmount)
-{
-    int bits = static_cast<int>(bitcrushAmount);
-    float maxValue = std::pow(2, bits) - 1;
-    float crushedSample = std::round(sample * maxValue) / maxValue;
-
-    float shapedSample = waveShaper.processSample(crushedSample);
-    // Mix between crushed and shaped sample
-    // return crushedSample * (1.0f - waveshapeAmount) + shapedSample * waveshapeAmount;
-
-    return shapedSample;
-}
-
-float AudioDelayAudioProcessor::applyLFO(float baseValue, float lfoAmount, float lfoValue, float minValue, float maxValue)
-{
-    float range = maxValue - minValue;
-    float modulation = lfoValue * lfoAmount * range * 0.5f;
-    return juce::jlimit(minValue, maxValue, baseValue + modulation);
-}
-
-float AudioDelayAudioProcessor::applyLFOToPan(float basePan, float lfoAmount, float lfoValue)
-{
-    // Assume lfoValue is in the range [0, 1]
-    // Convert it to the range [-1, 1]
-    float bipolarLFO = 2.0f * lfoValue - 1.0f;
-
-    // Calculate the modulation, scaling it by lfoAmount
-    float modulation = bipolarLFO * lfoAmount;
-
-    // Apply the modulation to the base pan
-    // This ensures that when basePan is 0 (center), the LFO modulates equally in both directions
-    float modifiedPan = basePan + (1.0f - std::abs(basePan)) * modulation;
-
-    // Limit the result to the valid range [-1, 1]
-    return juce::jlimit(-1.0f, 1.0f, modifiedPan);
-}
-
-float AudioDelayAudioProcessor::applyLFOToDelay(float delayInSamples, float lfoAmount, float smoothedLFO)
-{
-    if (lfoDelayParameter->load() > 0.5f)
-    {
-        return delayInSamples * (1.0f + smoothedLFO * lfoAmount * 0.2f);
-    }
-    return delayInSamples;
-}
-
 juce::AudioProcessor *JUCE_CALLTYPE createPluginFilter()
 {
     return new AudioDelayAudioProcessor();
@@ -774,25 +547,35 @@ double AudioDelayAudioProcessor::getTailLengthSeconds() const
 
 int AudioDelayAudioProcessor::getNumPrograms()
 {
-    return 1;
+    return presetBank.getNumPresets();
 }
 
 int AudioDelayAudioProcessor::getCurrentProgram()
 {
-    return 0;
+    return currentProgram;
 }
 
 void AudioDelayAudioProcessor::setCurrentProgram(int index)
 {
+    if (!juce::isPositiveAndBelow(index, presetBank.getNumPresets()))
+        return;
+
+    // Snapshots are preloaded, so this is just a parameter copy picked up by the next block
+    currentProgram = index;
+    presetBank.getSnapshot(index).applyTo(parameters);
 }
 
 const juce::String AudioDelayAudioProcessor::getProgramName(int index)
 {
-    return {};
+    if (!juce::isPositiveAndBelow(index, presetBank.getNumPresets()))
+        return {};
+
+    return presetBank.getName(index);
 }
 
 void AudioDelayAudioProcessor::changeProgramName(int index, const juce::String &newName)
 {
+    presetBank.setName(index, newName);
 }
 
 bool AudioDelayAudioProcessor::hasEditor() const
@@ -807,13 +590,45 @@ juce::AudioProcessorEditor *AudioDelayAudioProcessor::createEditor()
 
 void AudioDelayAudioProcessor::getStateInformation(juce::MemoryBlock &destData)
 {
-    auto state = parameters.copyState();
-    std::unique_ptr<juce::XmlElement> xml(state.createXml());
-    copyXmlToBinary(*xml, destData);
+    // Compact binary snapshot straight from the parameter values, no ValueTree or XML
+    juce::MemoryOutputStream stream(destData, false);
+    ParameterSnapshot::writeHeader(stream);
+    ParameterSnapshot::capture(parameters).writeTo(stream);
+
+    const juce::SpinLock::ScopedLockType lock(morphLock);
+    morphSnapshots[0].writeTo(stream);
+    morphSnapshots[1].writeTo(stream);
 }
 
 void AudioDelayAudioProcessor::setStateInformation(const void *data, int sizeInBytes)
 {
+    if (ParameterSnapshot::isBinaryState(data, sizeInBytes))
+    {
+        juce::MemoryInputStream stream(data, static_cast<size_t>(sizeInBytes), false);
+        int version = ParameterSnapshot::readHeader(stream);
+        DBG("Loading binary state version " << version);
+
+        auto snapshot = ParameterSnapshot::capture(parameters);
+        snapshot.readFrom(stream);
+
+        if (version >= 2)
+        {
+            auto morphA = snapshot;
+            auto morphB = snapshot;
+            morphA.readFrom(stream);
+            morphB.readFrom(stream);
+
+            // The engine reads these directly while morphing, so nothing else holds them to the parameter ranges
+            morphA.constrainTo(parameters);
+            morphB.constrainTo(parameters);
+            setMorphSnapshots(morphA, morphB);
+        }
+
+        snapshot.applyTo(parameters);
+        return;
+    }
+
+    // Sessions saved before the binary format stored the parameter tree as XML
     std::unique_ptr<juce::XmlElement> xmlState(getXmlFromBinary(data, sizeInBytes));
     if (xmlState.get() != nullptr)
         if (xmlState->hasTagName(parameters.state.getType()))
@@ -3,8 +3,8 @@
 #include <juce_audio_processors/juce_audio_processors.h>
 #include <juce_dsp/juce_dsp.h>
 #include <juce_core/juce_core.h>
-#include "LFOManager.h"
-#include "DelayManager.h"
+#include "DelayEngine.h"
+#include "PresetBank.h"
 
 class AudioDelayAudioProcessor : public juce::AudioProcessor,
                                  public juce::AudioProcessorValueTreeState::Listener,
@@ -14,12 +14,12 @@ public:
   AudioDelayAudioProcessor();
   ~AudioDelayAudioProcessor() override;
 
-  juce::dsp::IIR::Filter<float> chorusLowpass;
-
   void prepareToPlay(double sampleRate, int samplesPerBlock) override;
   void releaseResources() override;
   bool isBusesLayoutSupported(const BusesLayout &layouts) const override;
   void processBlock(juce::AudioBuffer<float> &, juce::MidiBuffer &) override;
+  void processBlock(juce::AudioBuffer<double> &, juce::MidiBuffer &) override;
+  bool supportsDoublePrecisionProcessing() const override;
   juce::AudioProcessorEditor *createEditor() override;
   bool hasEditor() const override;
   const juce::String getName() const override;
@@ -40,6 +40,16 @@ public:
 
   juce::AudioProcessorValueTreeState &getParameters() { return parameters; }
 
+  // Per-stage timings of the audio thread; disabled until setEnabled(true) is called on it
+  StageProfiler &getProfiler() { return profiler; }
+  StageProfiler::StageStats getStageStats(StageProfiler::Stage stage) const { return profiler.getStats(stage); }
+
+  // Decimated wet signal for the editor's scope
+  ScopeFifo &getScopeFifo() { return scopeFifo; }
+
+  // Captures the current parameter values as morph end point A (slot 0) or B (slot 1)
+  void storeMorphSnapshot(int slot);
+
   enum TempoSync
   {
     Unsync,
@@ -65,33 +75,21 @@ public:
 
 private:
   juce::AudioProcessorValueTreeState parameters;
-  LFOManager lfoManager;
-  DelayManager delayManager;
-  juce::dsp::DryWetMixer<float> dryWetMixer;
-  juce::dsp::Panner<float> panner;
-
-  juce::dsp::Convolution convolution;
-  juce::AudioBuffer<float> impulseResponse;
-  juce::dsp::WaveShaper<float> waveShaper;
-
-  void createImpulseResponse();
-  float customWaveshaper(float sample);
-
-  juce::dsp::DelayLine<float, juce::dsp::DelayLineInterpolationTypes::Linear> chorusDelayLine;
+  std::unique_ptr<DelayEngine<float>> floatEngine;
+  std::unique_ptr<DelayEngine<double>> doubleEngine;
+  StageProfiler profiler;
+  ScopeFifo scopeFifo;
+  PresetBank presetBank;
+  int currentProgram = 0;
+
+  // Morph end points: written on the message thread under the lock, copied by the audio thread when changed.
+  // Each thread's side starts its own cache line, so the editor's writes never evict the audio thread's copy
+  alignas(64) juce::SpinLock morphLock;
+  std::array<ParameterSnapshot, 2> morphSnapshots;
+  std::atomic<bool> morphSnapshotsChanged{false};
+  alignas(64) std::array<ParameterSnapshot, 2> audioMorphSnapshots;
 
   std::atomic<float> *waveshapeAmountParameter = nullptr;
-
-  juce::dsp::ProcessorDuplicator<juce::dsp::IIR::Filter<float>, juce::dsp::IIR::Coefficients<float>> highpassFilter;
-  juce::dsp::ProcessorDuplicator<juce::dsp::IIR::Filter<float>, juce::dsp::IIR::Coefficients<float>> lowpassFilter;
-
-  static const int NUM_DIFFUSION_FILTERS = 4;
-  std::array<juce::dsp::StateVariableTPTFilter<float>, NUM_DIFFUSION_FILTERS> diffusionFilters;
-  juce::dsp::StateVariableTPTFilter<float> preDiffusionLowpass;
-  juce::dsp::StateVariableTPTFilter<float> postDiffusionLowpass;
-
-  std::array<juce::dsp::IIR::Filter<float>, 2> dcBlocker;
-  std::array<juce::dsp::IIR::Filter<float>, 2> finalDCBlocker;
-
   std::atomic<float> *delayParameter = nullptr;
   std::atomic<float> *feedbackParameter = nullptr;
   std::atomic<float> *mixParameter = nullptr;
@@ -109,35 +107,42 @@ private:
   std::atomic<float> *lfoPanParameter = nullptr;
   std::atomic<float> *lfoTempoSyncParameter = nullptr;
   std::atomic<float> *smearParameter = nullptr;
+  std::atomic<float> *lfoDelayParameter = nullptr;
+  std::atomic<float> *morphParameter = nullptr;
+  std::atomic<float> *morphEnabledParameter = nullptr;
+  std::atomic<float> *delayJumpParameter = nullptr;
+  std::atomic<float> *fdnLinesParameter = nullptr;
+  std::atomic<float> *freezeParameter = nullptr;
+  std::atomic<float> *shimmerParameter = nullptr;
+  std::atomic<float> *shimmerPitchParameter = nullptr;
+  std::atomic<float> *reverseParameter = nullptr;
+  std::atomic<float> *lfo2FreqParameter = nullptr;
+  std::atomic<float> *filterSlopeParameter = nullptr;
+  std::atomic<float> *spectralParameter = nullptr;
+  std::atomic<float> *spectralHopParameter = nullptr;
+  std::atomic<float> *spectralTiltParameter = nullptr;
+  std::array<std::atomic<float> *, ModulationRoute::MAX_ROUTES> modSourceParameters{};
+  std::array<std::atomic<float> *, ModulationRoute::MAX_ROUTES> modDestinationParameters{};
+  std::array<std::atomic<float> *, ModulationRoute::MAX_ROUTES> modDepthParameters{};
 
   double lastKnownBPM;
-  float chorusRate;
-  float chorusDepth;
-  float chorusPhase;
-  float chorusPhaseIncrement;
 
   juce::AudioProcessorValueTreeState::ParameterLayout createParameterLayout();
   void updateLFOFrequency();
   void updateBPMIfChanged();
-  void processDelayAndEffects(int channel, int sample, const float *inputData, float *wetData, float feedback, float bitcrushAmount, float smearAmount, float lfoAmount, float waveshapeAmount);
-  float applyLFOToBitcrush(float bitcrushAmount, float lfoAmount, float smoothedLFO);
-  void applyLFOToFilters(float smoothedLFO, float lfoAmount);
-  float processDelaySample(int channel, float delayInSamples, float smearAmount, float lfoModulation);
-  void updateChorusPhase();
-  void applyFiltersToWetSignal(juce::AudioBuffer<float> &wetBuffer);
-  void applyStereoWidth(juce::AudioBuffer<float> &wetBuffer, float stereoWidth);
-  void applyPanning(juce::AudioBuffer<float> &wetBuffer, float pan, float lfoAmount);
-  void mixDryWetSignals(juce::AudioBuffer<float> &buffer, const juce::AudioBuffer<float> &dryBuffer, const juce::AudioBuffer<float> &wetBuffer, float mix);
-  void applyFinalDCBlocking(juce::AudioBuffer<float> &buffer);
-  void updateFilterParameters();
-  void updateDiffusionFilters();
-  float processDiffusionFilters(float input, int channel);
-  float applyBitcrushing(float sample, float bitcrushAmount, float waveshapeAmount);
-  float applyLFO(float baseValue, float lfoAmount, float lfoValue, float minValue, float maxValue);
-  float applyLFOToPan(float basePan, float lfoAmount, float lfoValue);
+  DelayParameters takeParameterSnapshot() const;
+  static DelayParameters toDelayParameters(const ParameterSnapshot &snapshot);
+  static int getNetworkLineCount(float choiceIndex);
+  static float getShimmerSemitones(float choiceIndex);
+  static int getFilterSlope(float choiceIndex);
+  static int getSpectralHop(float choiceIndex);
+  void refreshMorphSnapshots();
+  void setMorphSnapshots(const ParameterSnapshot &a, const ParameterSnapshot &b);
+  template <typename SampleType>
+  void processSamples(juce::AudioBuffer<SampleType> &buffer, DelayEngine<SampleType> &engine);
+  float getSyncedDelayTime(int syncMode);
+  float getSyncedLFOFrequency(int syncMode);
   void updateDelayTimeFromSync();
-  std::atomic<float> *lfoDelayParameter = nullptr;
-  float applyLFOToDelay(float delayInSamples, float lfoAmount, float smoothedLFO);
 
   JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(AudioDelayAudioProcessor)
 };
\ No newline at end of file
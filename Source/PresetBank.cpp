@@ -0,0 +1,96 @@
+#include "PresetBank.h"
+
+PresetBank::PresetBank(const ParameterSnapshot &defaults)
+{
+    addPreset("Init", defaults);
+
+    auto slapback = defaults;
+    slapback[ParameterSnapshot::Delay] = 110.0f;
+    slapback[ParameterSnapshot::Feedback] = 0.15f;
+    slapback[ParameterSnapshot::Mix] = 0.35f;
+    addPreset("Slapback", slapback);
+
+    auto dub = defaults;
+    dub[ParameterSnapshot::TempoSync] = 15.0f; // 1/4D
+    dub[ParameterSnapshot::Delay] = 750.0f;
+    dub[ParameterSnapshot::Feedback] = 0.7f;
+    dub[ParameterSnapshot::Mix] = 0.4f;
+    dub[ParameterSnapshot::HighpassFreq] = 150.0f;
+    dub[ParameterSnapshot::LowpassFreq] = 3000.0f;
+    addPreset("Dub Echo", dub);
+
+    auto tape = defaults;
+    tape[ParameterSnapshot::Delay] = 320.0f;
+    tape[ParameterSnapshot::Feedback] = 0.45f;
+    tape[ParameterSnapshot::Bitcrush] = 10.0f;
+    tape[ParameterSnapshot::LowpassFreq] = 6000.0f;
+    tape[ParameterSnapshot::LFOFreq] = 0.5f;
+    tape[ParameterSnapshot::LFOAmount] = 0.3f;
+    tape[ParameterSnapshot::LFODelay] = 1.0f;
+    addPreset("Lo-Fi Tape", tape);
+
+    auto wash = defaults;
+    wash[ParameterSnapshot::Delay] = 600.0f;
+    wash[ParameterSnapshot::Feedback] = 0.8f;
+    wash[ParameterSnapshot::StereoWidth] = 1.6f;
+    wash[ParameterSnapshot::Smear] = 0.8f;
+    addPreset("Smeared Wash", wash);
+
+    auto pingPan = defaults;
+    pingPan[ParameterSnapshot::Delay] = 250.0f;
+    pingPan[ParameterSnapshot::Feedback] = 0.55f;
+    pingPan[ParameterSnapshot::LFOFreq] = 2.0f;
+    pingPan[ParameterSnapshot::LFOAmount] = 0.8f;
+    pingPan[ParameterSnapshot::LFOPan] = 1.0f;
+    addPreset("Auto Pan", pingPan);
+
+    auto crushed = defaults;
+    crushed[ParameterSnapshot::Delay] = 180.0f;
+    crushed[ParameterSnapshot::Feedback] = 0.6f;
+    crushed[ParameterSnapshot::Bitcrush] = 5.0f;
+    crushed[ParameterSnapshot::WaveshapeAmount] = 0.8f;
+    crushed[ParameterSnapshot::LFOAmount] = 0.5f;
+    crushed[ParameterSnapshot::LFOBitcrush] = 1.0f;
+    addPreset("Crushed Pulse", crushed);
+
+    // Narrow, steep band-limited repeats, the sound of a phone line
+    auto telephone = defaults;
+    telephone[ParameterSnapshot::Delay] = 280.0f;
+    telephone[ParameterSnapshot::Feedback] = 0.5f;
+    telephone[ParameterSnapshot::Mix] = 0.45f;
+    telephone[ParameterSnapshot::HighpassFreq] = 400.0f;
+    telephone[ParameterSnapshot::LowpassFreq] = 3000.0f;
+    telephone[ParameterSnapshot::FilterSlope] = 3.0f; // 48 dB/oct
+    telephone[ParameterSnapshot::WaveshapeAmount] = 0.7f;
+    addPreset("Telephone", telephone);
+
+    // Highs trail the lows and blur into a pad as they repeat
+    auto spectral = defaults;
+    spectral[ParameterSnapshot::Delay] = 400.0f;
+    spectral[ParameterSnapshot::Feedback] = 0.7f;
+    spectral[ParameterSnapshot::Smear] = 0.6f;
+    spectral[ParameterSnapshot::Spectral] = 1.0f;
+    spectral[ParameterSnapshot::SpectralTilt] = 0.6f;
+    addPreset("Spectral Smear", spectral);
+}
+
+void PresetBank::addPreset(const juce::String &name, const ParameterSnapshot &snapshot)
+{
+    presets.push_back({name, snapshot});
+}
+
+const juce::String &PresetBank::getName(int index) const
+{
+    return presets[static_cast<size_t>(juce::jlimit(0, getNumPresets() - 1, index))].name;
+}
+
+const ParameterSnapshot &PresetBank::getSnapshot(int index) const
+{
+    return presets[static_cast<size_t>(juce::jlimit(0, getNumPresets() - 1, index))].snapshot;
+}
+
+void PresetBank::setName(int index, const juce::String &newName)
+{
+    if (juce::isPositiveAndBelow(index, getNumPresets()))
+        presets[static_cast<size_t>(index)].name = newName;
+}
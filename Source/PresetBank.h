@@ -0,0 +1,32 @@
+#pragma once
+
+#include <juce_core/juce_core.h>
+#include <vector>
+#include "ParameterSnapshot.h"
+
+// Factory programs held as ready-made snapshots, so switching program is a straight copy
+// into the parameters with no parsing.
+class PresetBank
+{
+public:
+    // defaults is the layout's default state; factory presets are expressed as changes to it
+    explicit PresetBank(const ParameterSnapshot &defaults);
+
+    int getNumPresets() const { return static_cast<int>(presets.size()); }
+    const juce::String &getName(int index) const;
+    const ParameterSnapshot &getSnapshot(int index) const;
+
+    // Message thread only
+    void setName(int index, const juce::String &newName);
+
+private:
+    struct Preset
+    {
+        juce::String name;
+        ParameterSnapshot snapshot;
+    };
+
+    void addPreset(const juce::String &name, const ParameterSnapshot &snapshot);
+
+    std::vector<Preset> presets;
+};
@@ -0,0 +1,69 @@
+#include "ProfilerOverlay.h"
+
+ProfilerOverlay::ProfilerOverlay(StageProfiler &profilerToShow)
+    : profiler(profilerToShow)
+{
+  setInterceptsMouseClicks(false, false);
+}
+
+ProfilerOverlay::~ProfilerOverlay()
+{
+  stopTimer();
+}
+
+void ProfilerOverlay::visibilityChanged()
+{
+  if (isVisible())
+  {
+    timerCallback();
+    startTimerHz(4);
+  }
+  else
+  {
+    stopTimer();
+  }
+}
+
+void ProfilerOverlay::timerCallback()
+{
+  for (int i = 0; i < StageProfiler::NumStages; ++i)
+    stats[static_cast<size_t>(i)] = profiler.getStats(static_cast<StageProfiler::Stage>(i));
+
+  repaint();
+}
+
+void ProfilerOverlay::paint(juce::Graphics &g)
+{
+  g.setColour(juce::Colours::black.withAlpha(0.8f));
+  g.fillRoundedRectangle(getLocalBounds().toFloat(), 6.0f);
+
+  auto area = getLocalBounds().reduced(10);
+  int rowHeight = 18;
+
+  auto drawRow = [&g, &area, rowHeight](const juce::String &name, const juce::String &calls, const juce::String &mean,
+                                        const juce::String &p99, const juce::String &max)
+  {
+    auto row = area.removeFromTop(rowHeight);
+    int column = row.getWidth() / 6;
+    g.drawText(name, row.removeFromLeft(column * 2), juce::Justification::centredLeft);
+    g.drawText(calls, row.removeFromLeft(column), juce::Justification::centredRight);
+    g.drawText(mean, row.removeFromLeft(column), juce::Justification::centredRight);
+    g.drawText(p99, row.removeFromLeft(column), juce::Justification::centredRight);
+    g.drawText(max, row, juce::Justification::centredRight);
+  };
+
+  g.setFont(juce::Font(juce::Font::getDefaultMonospacedFontName(), 13.0f, juce::Font::plain));
+  g.setColour(juce::Colours::lightgrey);
+  drawRow("Stage", "Calls", "Mean us", "p99 us", "Max us");
+
+  g.setColour(juce::Colours::white);
+  for (int i = 0; i < StageProfiler::NumStages; ++i)
+  {
+    const auto &stage = stats[static_cast<size_t>(i)];
+    drawRow(StageProfiler::getStageName(static_cast<StageProfiler::Stage>(i)),
+            juce::String(static_cast<juce::int64>(stage.count)),
+            juce::String(stage.meanMicroseconds, 2),
+            juce::String(stage.p99Microseconds, 2),
+            juce::String(stage.maxMicroseconds, 2));
+  }
+}
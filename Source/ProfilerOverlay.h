@@ -0,0 +1,24 @@
+#pragma once
+
+#include <juce_gui_basics/juce_gui_basics.h>
+#include "StageProfiler.h"
+
+// Live per-stage timing table drawn over the editor while the profiler is switched on
+class ProfilerOverlay : public juce::Component,
+                        private juce::Timer
+{
+public:
+  explicit ProfilerOverlay(StageProfiler &profilerToShow);
+  ~ProfilerOverlay() override;
+
+  void paint(juce::Graphics &) override;
+  void visibilityChanged() override;
+
+private:
+  void timerCallback() override;
+
+  StageProfiler &profiler;
+  std::array<StageProfiler::StageStats, StageProfiler::NumStages> stats;
+
+  JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(ProfilerOverlay)
+};
@@ -0,0 +1,66 @@
+#include "ScopeFifo.h"
+
+ScopeFifo::ScopeFifo()
+{
+    currentPoint.min = 1.0f;
+    currentPoint.max = -1.0f;
+}
+
+void ScopeFifo::prepare(double sampleRate, double secondsPerPoint)
+{
+    samplesPerPoint = juce::jmax(1, juce::roundToInt(sampleRate * secondsPerPoint));
+    samplesInCurrentPoint = 0;
+    currentPoint.min = 1.0f;
+    currentPoint.max = -1.0f;
+}
+
+template <typename SampleType>
+void ScopeFifo::pushBlock(const juce::AudioBuffer<SampleType> &buffer, int numSamples) noexcept
+{
+    if (!isActive())
+        return;
+
+    int numChannels = buffer.getNumChannels();
+    int position = 0;
+
+    while (position < numSamples)
+    {
+        int count = juce::jmin(numSamples - position, samplesPerPoint - samplesInCurrentPoint);
+
+        for (int channel = 0; channel < numChannels; ++channel)
+        {
+            auto range = juce::FloatVectorOperations::findMinAndMax(buffer.getReadPointer(channel, position), count);
+            currentPoint.min = juce::jmin(currentPoint.min, static_cast<float>(range.getStart()));
+            currentPoint.max = juce::jmax(currentPoint.max, static_cast<float>(range.getEnd()));
+        }
+
+        position += count;
+        samplesInCurrentPoint += count;
+
+        if (samplesInCurrentPoint == samplesPerPoint)
+        {
+            const auto scope = fifo.write(1);
+            if (scope.blockSize1 > 0)
+                points[static_cast<size_t>(scope.startIndex1)] = currentPoint;
+
+            samplesInCurrentPoint = 0;
+            currentPoint.min = 1.0f;
+            currentPoint.max = -1.0f;
+        }
+    }
+}
+
+int ScopeFifo::pull(Point *destination, int maxPoints) noexcept
+{
+    const auto scope = fifo.read(juce::jmin(maxPoints, fifo.getNumReady()));
+
+    for (int i = 0; i < scope.blockSize1; ++i)
+        destination[i] = points[static_cast<size_t>(scope.startIndex1 + i)];
+    for (int i = 0; i < scope.blockSize2; ++i)
+        destination[scope.blockSize1 + i] = points[static_cast<size_t>(scope.startIndex2 + i)];
+
+    return scope.blockSize1 + scope.blockSize2;
+}
+
+template void ScopeFifo::pushBlock<float>(const juce::AudioBuffer<float> &, int) noexcept;
+template void ScopeFifo::pushBlock<double>(const juce::AudioBuffer<double> &, int) noexcept;
@@ -0,0 +1,48 @@
+#pragma once
+
+#include <juce_audio_basics/juce_audio_basics.h>
+#include <array>
+#include <atomic>
+
+// Decimated min/max points of the wet signal, handed from the audio thread to the editor.
+// Single producer, single consumer; when the reader falls behind, new points are dropped
+// rather than ever blocking the audio thread.
+class ScopeFifo
+{
+public:
+    struct Point
+    {
+        float min = 0.0f;
+        float max = 0.0f;
+    };
+
+    static const int FIFO_SIZE = 1024;
+
+    ScopeFifo();
+
+    // Called before playback starts; one point covers secondsPerPoint of audio
+    void prepare(double sampleRate, double secondsPerPoint);
+
+    // Only pushes while a view is reading, so a closed editor costs one relaxed atomic load
+    void setActive(bool shouldBeActive) noexcept { active.store(shouldBeActive, std::memory_order_relaxed); }
+    bool isActive() const noexcept { return active.load(std::memory_order_relaxed); }
+
+    // Audio thread; channels are folded together, keeping the extreme values
+    template <typename SampleType>
+    void pushBlock(const juce::AudioBuffer<SampleType> &buffer, int numSamples) noexcept;
+
+    // Message thread; returns the number of points copied into destination
+    int pull(Point *destination, int maxPoints) noexcept;
+
+private:
+    juce::AbstractFifo fifo{FIFO_SIZE};
+    std::array<Point, FIFO_SIZE> points;
+
+    // Written by the message thread; its own cache line so it never shares one with the audio thread's state below
+    alignas(64) std::atomic<bool> active{false};
+
+    // Audio thread only
+    alignas(64) int samplesPerPoint = 256;
+    int samplesInCurrentPoint = 0;
+    Point currentPoint;
+};
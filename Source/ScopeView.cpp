@@ -0,0 +1,76 @@
+#include "ScopeView.h"
+
+ScopeView::ScopeView(ScopeFifo &fifoToRead)
+    : fifo(fifoToRead)
+{
+  setOpaque(true);
+  setInterceptsMouseClicks(false, false);
+}
+
+ScopeView::~ScopeView()
+{
+  stopTimer();
+  fifo.setActive(false);
+}
+
+void ScopeView::visibilityChanged()
+{
+  // Only ask the audio thread for points while something can show them
+  bool visible = isVisible();
+  fifo.setActive(visible);
+
+  if (visible)
+    startTimerHz(FRAME_RATE_HZ);
+  else
+    stopTimer();
+}
+
+void ScopeView::resized()
+{
+  // Border and centre line never change, so draw them once per size
+  frame = juce::Image(juce::Image::RGB, juce::jmax(1, getWidth()), juce::jmax(1, getHeight()), true);
+  juce::Graphics g(frame);
+
+  g.fillAll(juce::Colours::white);
+  g.setColour(juce::Colours::lightgrey);
+  g.drawHorizontalLine(getHeight() / 2, 0.0f, static_cast<float>(getWidth()));
+  g.setColour(juce::Colours::black);
+  g.drawRect(getLocalBounds(), 1);
+}
+
+void ScopeView::timerCallback()
+{
+  int numPulled = fifo.pull(incoming.data(), static_cast<int>(incoming.size()));
+  if (numPulled == 0)
+    return;
+
+  for (int i = 0; i < numPulled; ++i)
+  {
+    history[static_cast<size_t>(writeIndex)] = incoming[static_cast<size_t>(i)];
+    writeIndex = (writeIndex + 1) % NUM_POINTS;
+  }
+
+  repaint();
+}
+
+void ScopeView::paint(juce::Graphics &g)
+{
+  g.drawImageAt(frame, 0, 0);
+
+  auto area = getLocalBounds().reduced(2).toFloat();
+  float centre = area.getCentreY();
+  float halfHeight = area.getHeight() * 0.5f;
+  float columnWidth = area.getWidth() / static_cast<float>(NUM_POINTS);
+
+  // Oldest point on the left, newest on the right
+  g.setColour(juce::Colours::black);
+  for (int i = 0; i < NUM_POINTS; ++i)
+  {
+    const auto &point = history[static_cast<size_t>((writeIndex + i) % NUM_POINTS)];
+    float top = centre - juce::jlimit(-1.0f, 1.0f, point.max) * halfHeight;
+    float bottom = centre - juce::jlimit(-1.0f, 1.0f, point.min) * halfHeight;
+    float x = area.getX() + static_cast<float>(i) * columnWidth;
+
+    g.drawVerticalLine(juce::roundToInt(x), top, juce::jmax(top + 1.0f, bottom));
+  }
+}
@@ -0,0 +1,33 @@
+#pragma once
+
+#include <juce_gui_basics/juce_gui_basics.h>
+#include "ScopeFifo.h"
+
+// Scrolling min/max display of the wet signal. Pulls from the processor's ScopeFifo at a
+// bounded frame rate and only repaints when new points have arrived.
+class ScopeView : public juce::Component,
+                  private juce::Timer
+{
+public:
+  explicit ScopeView(ScopeFifo &fifoToRead);
+  ~ScopeView() override;
+
+  void paint(juce::Graphics &) override;
+  void resized() override;
+  void visibilityChanged() override;
+
+private:
+  void timerCallback() override;
+
+  static const int NUM_POINTS = 256;
+  static const int FRAME_RATE_HZ = 30;
+
+  ScopeFifo &fifo;
+  std::array<ScopeFifo::Point, NUM_POINTS> history{};
+  std::array<ScopeFifo::Point, ScopeFifo::FIFO_SIZE> incoming{};
+  int writeIndex = 0;
+
+  juce::Image frame;
+
+  JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(ScopeView)
+};
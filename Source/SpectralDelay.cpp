@@ -0,0 +1,260 @@
+#include "SpectralDelay.h"
+
+namespace
+{
+    // Every buffer starts on its own cache line
+    const size_t ALIGNMENT_FLOATS = 16;
+
+    size_t alignedFloats(size_t count)
+    {
+        return (count + ALIGNMENT_FLOATS - 1) / ALIGNMENT_FLOATS * ALIGNMENT_FLOATS;
+    }
+
+    // Hann analysis times Hann synthesis, four frames deep, sums to 1.5 at every sample
+    const float OVERLAP_ADD_GAIN = 2.0f / 3.0f;
+}
+
+template <typename SampleType>
+int SpectralDelay<SampleType>::getHistoryFrames(int hop, double sampleRate, double maximumDelaySeconds)
+{
+    return static_cast<int>(std::ceil(maximumDelaySeconds * sampleRate / hop)) + 1;
+}
+
+template <typename SampleType>
+size_t SpectralDelay<SampleType>::getRequiredFloats(int hop, int numChannels, int historyFrames)
+{
+    const auto frameLength = static_cast<size_t>(hop * OVERLAP);
+    const auto bins = frameLength / 2 + 1;
+
+    size_t perChannel = 2 * alignedFloats(frameLength) + alignedFloats(bins) + alignedFloats(static_cast<size_t>(historyFrames) * 2 * bins);
+    return alignedFloats(frameLength) + alignedFloats(2 * frameLength) + static_cast<size_t>(numChannels) * perChannel;
+}
+
+template <typename SampleType>
+void SpectralDelay<SampleType>::prepare(const juce::dsp::ProcessSpec &spec, double maximumDelaySeconds)
+{
+    sampleRate = spec.sampleRate;
+    maximumDelay = maximumDelaySeconds;
+    channels.assign(spec.numChannels, ChannelState());
+
+    // Plans for every hop are made up front; switching hop only picks a different one
+    for (size_t i = 0; i < transforms.size(); ++i)
+        if (transforms[i] == nullptr)
+            transforms[i] = std::make_unique<juce::dsp::FFT>(juce::roundToInt(std::log2(MIN_HOP * OVERLAP)) + static_cast<int>(i));
+
+    // Short hops need the most history frames, so the block is sized for the shortest
+    size_t requiredFloats = 0;
+    for (int hop = MIN_HOP; hop <= MAX_HOP; hop *= 2)
+        requiredFloats = juce::jmax(requiredFloats, getRequiredFloats(hop, static_cast<int>(channels.size()), getHistoryFrames(hop, sampleRate, maximumDelay)));
+
+    storageBytes = (requiredFloats + ALIGNMENT_FLOATS) * sizeof(float);
+    storage.malloc(storageBytes);
+
+    layoutBuffers();
+    updateSmearCoefficient();
+    reset();
+}
+
+template <typename SampleType>
+void SpectralDelay<SampleType>::layoutBuffers()
+{
+    frameSize = hopSize * OVERLAP;
+    numBins = frameSize / 2 + 1;
+    historyFrames = getHistoryFrames(hopSize, sampleRate, maximumDelay);
+    transform = transforms[static_cast<size_t>(juce::roundToInt(std::log2(hopSize / MIN_HOP)))].get();
+
+    auto address = reinterpret_cast<uintptr_t>(storage.get());
+    auto *next = reinterpret_cast<float *>((address + ALIGNMENT_FLOATS * sizeof(float) - 1) & ~(uintptr_t)(ALIGNMENT_FLOATS * sizeof(float) - 1));
+    auto carve = [&next](size_t count)
+    {
+        auto *region = next;
+        next += alignedFloats(count);
+        return region;
+    };
+
+    window = carve(static_cast<size_t>(frameSize));
+    frame = carve(2 * static_cast<size_t>(frameSize));
+    for (auto &state : channels)
+    {
+        state.input = carve(static_cast<size_t>(frameSize));
+        state.output = carve(static_cast<size_t>(frameSize));
+        state.magnitudes = carve(static_cast<size_t>(numBins));
+        state.history = carve(static_cast<size_t>(historyFrames) * 2 * static_cast<size_t>(numBins));
+    }
+    jassert(reinterpret_cast<char *>(next) <= storage.get() + storageBytes);
+
+    // Periodic Hann, so shifted copies four hops apart overlap-add to a constant
+    for (int i = 0; i < frameSize; ++i)
+        window[i] = 0.5f - 0.5f * std::cos(juce::MathConstants<float>::twoPi * static_cast<float>(i) / static_cast<float>(frameSize));
+
+    // Octave bands down from Nyquist; the lowest takes whatever is left below 1/128 of it
+    const int half = frameSize / 2;
+    bandEdges[0] = 0;
+    for (int band = 1; band < NUM_BANDS; ++band)
+        bandEdges[static_cast<size_t>(band)] = half >> (NUM_BANDS - band);
+    bandEdges[NUM_BANDS] = numBins;
+
+    bandDelays.fill(1);
+    bandFeedback.fill(0.0f);
+    bandRatios.fill(1.0);
+}
+
+template <typename SampleType>
+void SpectralDelay<SampleType>::reset()
+{
+    const int numChannels = static_cast<int>(channels.size());
+    for (int channel = 0; channel < numChannels; ++channel)
+    {
+        auto &state = channels[static_cast<size_t>(channel)];
+        juce::FloatVectorOperations::clear(state.input, frameSize);
+        juce::FloatVectorOperations::clear(state.output, frameSize);
+        juce::FloatVectorOperations::clear(state.magnitudes, numBins);
+        juce::FloatVectorOperations::clear(state.history, historyFrames * 2 * numBins);
+        state.position = 0;
+        state.historyWrite = 0;
+
+        // Channels take their frames at different points in the hop, so no one block runs them all
+        state.hopCounter = channel * hopSize / juce::jmax(1, numChannels);
+    }
+}
+
+template <typename SampleType>
+void SpectralDelay<SampleType>::setHopSize(int newHopSize)
+{
+    newHopSize = juce::jlimit(MIN_HOP, MAX_HOP, juce::nextPowerOfTwo(newHopSize));
+    if (newHopSize == hopSize)
+        return;
+
+    hopSize = newHopSize;
+    if (storage == nullptr)
+        return;
+
+    layoutBuffers();
+    updateSmearCoefficient();
+    reset();
+}
+
+template <typename SampleType>
+void SpectralDelay<SampleType>::setDelayAndFeedback(SampleType delayInSamples, SampleType feedback, SampleType tilt)
+{
+    for (int band = 0; band < NUM_BANDS; ++band)
+    {
+        const double position = 2.0 * band / (NUM_BANDS - 1) - 1.0; // -1 lowest band, 1 highest
+        const double ratio = std::exp2(static_cast<double>(tilt) * position);
+        const auto index = static_cast<size_t>(band);
+
+        bandDelays[index] = juce::jlimit(1, historyFrames - 1, juce::roundToInt(static_cast<double>(delayInSamples) * ratio / hopSize));
+        bandRatios[index] = ratio;
+    }
+    setFeedback(feedback);
+}
+
+template <typename SampleType>
+void SpectralDelay<SampleType>::setFeedback(SampleType feedback)
+{
+    for (size_t band = 0; band < NUM_BANDS; ++band)
+        bandFeedback[band] = feedback > SampleType(0) ? static_cast<float>(std::pow(static_cast<double>(feedback), bandRatios[band])) : 0.0f;
+}
+
+template <typename SampleType>
+void SpectralDelay<SampleType>::setSmear(SampleType amount)
+{
+    if (amount == smearAmount)
+        return;
+
+    smearAmount = amount;
+    updateSmearCoefficient();
+}
+
+template <typename SampleType>
+void SpectralDelay<SampleType>::updateSmearCoefficient()
+{
+    // One-pole per frame, with the time constant in seconds so every hop blurs alike
+    const double timeConstant = 0.3 * static_cast<double>(smearAmount);
+    smearCoefficient = timeConstant > 0.0 ? static_cast<float>(std::exp(-hopSize / (timeConstant * sampleRate))) : 0.0f;
+}
+
+template <typename SampleType>
+SampleType SpectralDelay<SampleType>::popSample(int channel)
+{
+    const auto &state = channels[static_cast<size_t>(channel)];
+    return static_cast<SampleType>(state.output[state.position]);
+}
+
+template <typename SampleType>
+void SpectralDelay<SampleType>::pushSample(int channel, SampleType input)
+{
+    auto &state = channels[static_cast<size_t>(channel)];
+
+    // This output slot was just read; the frame that next covers it starts from zero
+    state.input[state.position] = static_cast<float>(input);
+    state.output[state.position] = 0.0f;
+    state.position = (state.position + 1) & (frameSize - 1);
+
+    if (++state.hopCounter >= hopSize)
+    {
+        state.hopCounter = 0;
+        processFrame(state);
+    }
+}
+
+template <typename SampleType>
+void SpectralDelay<SampleType>::processFrame(ChannelState &state)
+{
+    const int mask = frameSize - 1;
+
+    // The ring position is the oldest sample, so the frame reads in time order from there
+    for (int i = 0; i < frameSize; ++i)
+        frame[i] = state.input[(state.position + i) & mask] * window[i];
+
+    transform->performRealOnlyForwardTransform(frame, true);
+
+    // Each band reads its own frame back from the history and writes the input plus its feedback
+    // over the oldest one. The delayed spectrum, smeared, is both the output and what recirculates.
+    float *written = state.history + static_cast<size_t>(state.historyWrite) * 2 * static_cast<size_t>(numBins);
+    const bool smeared = smearCoefficient > 0.0f;
+
+    for (int band = 0; band < NUM_BANDS; ++band)
+    {
+        const auto index = static_cast<size_t>(band);
+        int readFrame = state.historyWrite - bandDelays[index];
+        if (readFrame < 0)
+            readFrame += historyFrames;
+
+        const float *delayed = state.history + static_cast<size_t>(readFrame) * 2 * static_cast<size_t>(numBins);
+        const float feedback = bandFeedback[index];
+
+        for (int bin = bandEdges[index]; bin < bandEdges[index + 1]; ++bin)
+        {
+            float real = delayed[2 * bin];
+            float imag = delayed[2 * bin + 1];
+
+            // Magnitude follows its own history, phase stays with the delayed frame
+            if (smeared)
+            {
+                const float magnitude = std::sqrt(real * real + imag * imag);
+                float &smoothed = state.magnitudes[bin];
+                smoothed = magnitude + smearCoefficient * (smoothed - magnitude);
+
+                const float scale = magnitude > 1.0e-9f ? smoothed / magnitude : 0.0f;
+                real *= scale;
+                imag *= scale;
+            }
+
+            written[2 * bin] = frame[2 * bin] + feedback * real;
+            written[2 * bin + 1] = frame[2 * bin + 1] + feedback * imag;
+            frame[2 * bin] = real;
+            frame[2 * bin + 1] = imag;
+        }
+    }
+
+    state.historyWrite = state.historyWrite + 1 < historyFrames ? state.historyWrite + 1 : 0;
+
+    transform->performRealOnlyInverseTransform(frame);
+
+    for (int i = 0; i < frameSize; ++i)
+        state.output[(state.position + i) & mask] += frame[i] * window[i] * OVERLAP_ADD_GAIN;
+}
+
+template class SpectralDelay<float>;
+template class SpectralDelay<double>;
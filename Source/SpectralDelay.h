@@ -0,0 +1,92 @@
+#pragma once
+
+#include <juce_dsp/juce_dsp.h>
+#include <array>
+#include <memory>
+#include <vector>
+
+// Per-channel spectral delay: an overlap-add STFT (periodic Hann analysis and synthesis windows,
+// frames of four hops) whose bins are delayed by whole frames and fed back in the frequency domain.
+// The spectrum is split into octave bands, each with its own delay and feedback, and an optional
+// smear lets every bin's magnitude follow its history slowly, blurring repeats across frames.
+//
+// Output lags the input by one frame on top of the band delays; getLatencySamples reports it so the
+// caller can line the dry signal up and tell the host. The transform runs in float whatever
+// SampleType is, since juce::dsp::FFT is float only. All buffers are carved from one aligned block
+// sized in prepare for the smallest hop, so changing the hop never allocates.
+template <typename SampleType>
+class SpectralDelay
+{
+public:
+    static const int NUM_BANDS = 8;
+    static const int MIN_HOP = 128;
+    static const int MAX_HOP = 1024;
+    static const int OVERLAP = 4; // frame length in hops
+
+    void prepare(const juce::dsp::ProcessSpec &spec, double maximumDelaySeconds);
+    void reset();
+
+    // 128, 256, 512 or 1024 samples; changing it clears the delay
+    void setHopSize(int newHopSize);
+    int getHopSize() const { return hopSize; }
+    int getLatencySamples() const { return frameSize; }
+
+    // The middle of the spectrum is delayed by delayInSamples; tilt spreads the bands up to an octave
+    // either side of it (positive delays the highs longer). Feedback is raised to the ratio of each
+    // band's delay, so all bands die away over the same time.
+    void setDelayAndFeedback(SampleType delayInSamples, SampleType feedback, SampleType tilt);
+
+    // Feedback alone, at the tilt last given to setDelayAndFeedback; cheap enough to follow a ramp
+    void setFeedback(SampleType feedback);
+
+    // 0 to 1: how long each bin's magnitude takes to follow the delayed spectrum, up to 300 ms
+    void setSmear(SampleType amount);
+
+    // Reads the output for this sample
+    SampleType popSample(int channel);
+
+    // Writes the new input; must follow popSample for the same channel. Runs a frame every hop.
+    void pushSample(int channel, SampleType input);
+
+private:
+    struct ChannelState
+    {
+        float *input = nullptr;      // frameSize ring, indexed by sample position
+        float *output = nullptr;     // frameSize ring of overlap-added output, same indexing
+        float *magnitudes = nullptr; // numBins smeared magnitudes
+        float *history = nullptr;    // historyFrames spectra of numBins interleaved complex values
+        int position = 0;
+        int hopCounter = 0;
+        int historyWrite = 0;
+    };
+
+    void layoutBuffers();
+    void processFrame(ChannelState &state);
+    void updateSmearCoefficient();
+    static size_t getRequiredFloats(int hop, int numChannels, int historyFrames);
+    static int getHistoryFrames(int hop, double sampleRate, double maximumDelaySeconds);
+
+    std::array<std::unique_ptr<juce::dsp::FFT>, 4> transforms; // one per hop size
+    juce::HeapBlock<char> storage;
+    size_t storageBytes = 0;
+
+    std::vector<ChannelState> channels;
+    float *window = nullptr;
+    float *frame = nullptr; // 2 * frameSize, as the real-only transforms require
+
+    double sampleRate = 44100.0;
+    double maximumDelay = 2.0;
+    int hopSize = 256;
+    int frameSize = 1024;
+    int numBins = 513;
+    int historyFrames = 0;
+    juce::dsp::FFT *transform = nullptr;
+
+    std::array<int, NUM_BANDS + 1> bandEdges{}; // first bin of each band, then numBins
+    std::array<int, NUM_BANDS> bandDelays{};    // in frames, at least one
+    std::array<float, NUM_BANDS> bandFeedback{};
+    std::array<double, NUM_BANDS> bandRatios{}; // each band's delay over the middle of the spectrum
+
+    SampleType smearAmount = 0;
+    float smearCoefficient = 0.0f;
+};
@@ -0,0 +1,97 @@
+#include "StageProfiler.h"
+
+StageProfiler::StageProfiler()
+{
+    reset();
+}
+
+void StageProfiler::reset() noexcept
+{
+    for (auto &data : stages)
+    {
+        for (auto &bucket : data.buckets)
+            bucket.store(0, std::memory_order_relaxed);
+
+        data.count.store(0, std::memory_order_relaxed);
+        data.totalNanoseconds.store(0, std::memory_order_relaxed);
+        data.maxNanoseconds.store(0, std::memory_order_relaxed);
+    }
+}
+
+void StageProfiler::record(Stage stage, juce::int64 nanoseconds) noexcept
+{
+    auto &data = stages[static_cast<size_t>(stage)];
+    auto duration = static_cast<juce::uint64>(juce::jmax(static_cast<juce::int64>(1), nanoseconds));
+
+    int bucket = juce::jmin(NUM_BUCKETS - 1, juce::findHighestSetBit(static_cast<juce::uint32>(juce::jmin(duration, static_cast<juce::uint64>(0xffffffffu)))));
+
+    data.buckets[static_cast<size_t>(bucket)].fetch_add(1, std::memory_order_relaxed);
+    data.count.fetch_add(1, std::memory_order_relaxed);
+    data.totalNanoseconds.fetch_add(duration, std::memory_order_relaxed);
+
+    // Single writer, so a plain compare-and-store is enough for the maximum
+    if (duration > data.maxNanoseconds.load(std::memory_order_relaxed))
+        data.maxNanoseconds.store(duration, std::memory_order_relaxed);
+}
+
+StageProfiler::StageStats StageProfiler::getStats(Stage stage) const
+{
+    const auto &data = stages[static_cast<size_t>(stage)];
+    StageStats stats;
+
+    juce::uint64 histogramTotal = 0;
+    for (size_t i = 0; i < data.buckets.size(); ++i)
+    {
+        stats.histogram[i] = data.buckets[i].load(std::memory_order_relaxed);
+        histogramTotal += stats.histogram[i];
+    }
+
+    stats.count = data.count.load(std::memory_order_relaxed);
+    stats.maxMicroseconds = static_cast<double>(data.maxNanoseconds.load(std::memory_order_relaxed)) / 1000.0;
+
+    if (stats.count > 0)
+        stats.meanMicroseconds = static_cast<double>(data.totalNanoseconds.load(std::memory_order_relaxed)) / 1000.0 / static_cast<double>(stats.count);
+
+    // Percentiles are reported as the upper edge of the bucket they fall in
+    auto percentile = [&stats, histogramTotal](double fraction)
+    {
+        auto threshold = static_cast<juce::uint64>(std::ceil(fraction * static_cast<double>(histogramTotal)));
+        juce::uint64 cumulative = 0;
+
+        for (int i = 0; i < NUM_BUCKETS; ++i)
+        {
+            cumulative += stats.histogram[static_cast<size_t>(i)];
+            if (cumulative >= threshold && cumulative > 0)
+                return bucketUpperBoundMicroseconds(i);
+        }
+        return 0.0;
+    };
+
+    stats.p50Microseconds = juce::jmin(stats.maxMicroseconds, percentile(0.5));
+    stats.p99Microseconds = juce::jmin(stats.maxMicroseconds, percentile(0.99));
+    return stats;
+}
+
+double StageProfiler::bucketUpperBoundMicroseconds(int bucket)
+{
+    return std::ldexp(1.0, bucket + 1) / 1000.0;
+}
+
+const char *StageProfiler::getStageName(Stage stage)
+{
+    switch (stage)
+    {
+    case WholeBlock:
+        return "Whole block";
+    case LFOGeneration:
+        return "LFO";
+    case DelayLoop:
+        return "Delay/feedback";
+    case Filters:
+        return "Filters";
+    case Output:
+        return "Width/pan/mix/DC";
+    default:
+        return "";
+    }
+}
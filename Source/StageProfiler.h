@@ -0,0 +1,94 @@
+#pragma once
+
+#include <juce_core/juce_core.h>
+#include <array>
+#include <atomic>
+#include <chrono>
+
+// Per-stage timing for the processing chain. The audio thread is the only writer and
+// aggregates into fixed log2 histograms; any thread can read stats without locking.
+// When disabled, each timed stage costs one relaxed atomic load. WholeBlock is recorded once per
+// host block, the engine stages once per internal sub-block.
+class StageProfiler
+{
+public:
+    enum Stage
+    {
+        WholeBlock,
+        LFOGeneration,
+        DelayLoop,
+        Filters,
+        Output, // width, pan and dry/wet mix, then the DC block
+        NumStages
+    };
+
+    // Bucket i holds durations in [2^i, 2^(i+1)) nanoseconds, the last one everything above
+    static const int NUM_BUCKETS = 32;
+
+    struct StageStats
+    {
+        juce::uint64 count = 0;
+        double meanMicroseconds = 0.0;
+        double maxMicroseconds = 0.0;
+        double p50Microseconds = 0.0;
+        double p99Microseconds = 0.0;
+        std::array<juce::uint32, NUM_BUCKETS> histogram{};
+    };
+
+    class ScopedTimer
+    {
+    public:
+        ScopedTimer(StageProfiler *profilerToUse, Stage stageToTime) noexcept
+            : profiler(profilerToUse != nullptr && profilerToUse->isEnabled() ? profilerToUse : nullptr),
+              stage(stageToTime)
+        {
+            if (profiler != nullptr)
+                start = Clock::now();
+        }
+
+        ~ScopedTimer()
+        {
+            if (profiler != nullptr)
+                profiler->record(stage, std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start).count());
+        }
+
+    private:
+        StageProfiler *profiler;
+        Stage stage;
+        std::chrono::steady_clock::time_point start;
+
+        JUCE_DECLARE_NON_COPYABLE(ScopedTimer)
+    };
+
+    StageProfiler();
+
+    void setEnabled(bool shouldBeEnabled) noexcept { enabled.store(shouldBeEnabled, std::memory_order_relaxed); }
+    bool isEnabled() const noexcept { return enabled.load(std::memory_order_relaxed); }
+
+    // Safe to call from any thread; counts recorded concurrently with a reset may be kept or dropped
+    void reset() noexcept;
+
+    void record(Stage stage, juce::int64 nanoseconds) noexcept;
+    StageStats getStats(Stage stage) const;
+
+    static const char *getStageName(Stage stage);
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    // One cache line per stage so readers never share a line with another stage's writes
+    struct alignas(64) StageData
+    {
+        std::array<std::atomic<juce::uint32>, NUM_BUCKETS> buckets;
+        std::atomic<juce::uint64> count;
+        std::atomic<juce::uint64> totalNanoseconds;
+        std::atomic<juce::uint64> maxNanoseconds;
+    };
+
+    std::array<StageData, NumStages> stages;
+
+    // Toggled from the editor, read by every timed stage; kept off the lines the audio thread writes
+    alignas(64) std::atomic<bool> enabled{false};
+
+    static double bucketUpperBoundMicroseconds(int bucket);
+};
@@ -0,0 +1,159 @@
+#pragma once
+
+#include <juce_dsp/juce_dsp.h>
+#include <cmath>
+#include "FastMath.h"
+
+// Memoryless saturation curves, each with its first antiderivative for antiderivative antialiasing
+// (ADAA). Every shape passes small signals at unity gain and is evaluated in double: the ADAA
+// quotient divides a difference of antiderivatives by a small step, and float rounding in that
+// difference would be audible as noise.
+namespace Waveshapes
+{
+    // log(cosh(x)) without overflow for large |x|
+    inline double logCosh(double x)
+    {
+        double magnitude = std::abs(x);
+        const double ln2 = 0.69314718055994530942;
+        return magnitude + std::log1p(std::exp(-2.0 * magnitude)) - ln2;
+    }
+
+    // Clamps to +-1
+    struct HardClip
+    {
+        static double apply(double x) { return juce::jlimit(-1.0, 1.0, x); }
+        static double antiderivative(double x) { return std::abs(x) <= 1.0 ? 0.5 * x * x : std::abs(x) - 0.5; }
+    };
+
+    struct Tanh
+    {
+        static double apply(double x) { return FastMath::tanh(x); }
+        static double antiderivative(double x) { return logCosh(x); }
+    };
+
+    // Cubic 1.5x - 0.5x^3, flat at +-1 from |x| = 1
+    struct SoftClip
+    {
+        static double apply(double x)
+        {
+            if (std::abs(x) >= 1.0)
+                return x > 0.0 ? 1.0 : -1.0;
+            return 1.5 * x - 0.5 * x * x * x;
+        }
+
+        static double antiderivative(double x)
+        {
+            if (std::abs(x) >= 1.0)
+                return std::abs(x) - 0.375;
+            double x2 = x * x;
+            return 0.75 * x2 - 0.125 * x2 * x2;
+        }
+    };
+
+    // Reflects off +-1 instead of clipping: a triangle wave of period 4 in the input
+    struct Foldback
+    {
+        static double apply(double x) { return 1.0 - std::abs(phase(x) - 2.0); }
+
+        // Periodic too, since a full period of the triangle integrates to zero
+        static double antiderivative(double x)
+        {
+            double t = phase(x);
+            return t <= 2.0 ? 0.5 * t * t - t + 0.5 : 3.0 * t - 0.5 * t * t - 3.5;
+        }
+
+        // Position within the period, 0 to 4, with x = 0 at 1
+        static double phase(double x)
+        {
+            double shifted = x + 1.0;
+            return shifted - 4.0 * std::floor(0.25 * shifted);
+        }
+    };
+
+    // tanh with the operating point moved off centre, so positive and negative halves saturate
+    // differently and add even harmonics like a biased triode. Leaves a DC offset for the
+    // feedback loop's DC blocker.
+    struct AsymmetricTube
+    {
+        static constexpr double bias = 0.5;
+
+        static double apply(double x) { return (FastMath::tanh(x + bias) - std::tanh(bias)) / gain(); }
+        static double antiderivative(double x) { return (logCosh(x + bias) - std::tanh(bias) * x) / gain(); }
+
+        // Slope at zero, 1 - tanh(bias)^2, divided out for unity small-signal gain
+        static double gain()
+        {
+            double t = std::tanh(bias);
+            return 1.0 - t * t;
+        }
+    };
+}
+
+// Per-channel waveshaper with first-order ADAA: each output is the mean of the curve between the
+// previous input and this one, (F(x[n]) - F(x[n-1])) / (x[n] - x[n-1]). This suppresses the aliases
+// a bare curve folds back from above Nyquist, at the cost of a half-sample delay and a gentle
+// top-octave rolloff, with no oversampling. The shape is a template argument, so the curve is
+// inlined into the caller's sample loop with no indirect call.
+//
+// Drive scales the input into the curve and the output back down again, so drive d clips at 1/d and
+// leaves anything quieter untouched. After reset the first sample of each channel seeds the previous
+// input with itself, so a shaper switched back in mid-signal doesn't average from zero.
+template <typename SampleType, typename Shape>
+class AntialiasedWaveshaper
+{
+public:
+    static const int NUM_CHANNELS = 2;
+
+    void setDrive(SampleType newDrive)
+    {
+        double drive = static_cast<double>(newDrive);
+        if (drive == currentDrive)
+            return;
+
+        // Previous inputs are kept in the driven domain; rescale them so the next step doesn't jump
+        for (int channel = 0; channel < NUM_CHANNELS; ++channel)
+        {
+            previousInput[channel] *= drive / currentDrive;
+            previousAntiderivative[channel] = Shape::antiderivative(previousInput[channel]);
+        }
+        currentDrive = drive;
+    }
+
+    SampleType processSample(int channel, SampleType input)
+    {
+        double x = static_cast<double>(input) * currentDrive;
+        double antiderivative = Shape::antiderivative(x);
+
+        if (!seeded[channel])
+        {
+            previousInput[channel] = x;
+            previousAntiderivative[channel] = antiderivative;
+            seeded[channel] = true;
+        }
+        double step = x - previousInput[channel];
+
+        // Too close to divide accurately; the curve at the midpoint is the limit of the quotient
+        double output = std::abs(step) > 1.0e-5 ? (antiderivative - previousAntiderivative[channel]) / step
+                                                : Shape::apply(0.5 * (x + previousInput[channel]));
+
+        previousInput[channel] = x;
+        previousAntiderivative[channel] = antiderivative;
+        return static_cast<SampleType>(output / currentDrive);
+    }
+
+    void reset()
+    {
+        for (int channel = 0; channel < NUM_CHANNELS; ++channel)
+        {
+            previousInput[channel] = 0.0;
+            previousAntiderivative[channel] = Shape::antiderivative(0.0);
+            seeded[channel] = false;
+        }
+    }
+
+private:
+    double currentDrive = 1.0;
+    double previousInput[NUM_CHANNELS] = {};
+    double previousAntiderivative[NUM_CHANNELS] = {};
+    bool seeded[NUM_CHANNELS] = {};
+};
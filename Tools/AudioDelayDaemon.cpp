@@ -0,0 +1,536 @@
+#include <juce_audio_processors/juce_audio_processors.h>
+#include <juce_audio_devices/juce_audio_devices.h>
+#include <juce_audio_formats/juce_audio_formats.h>
+#include <atomic>
+#include <chrono>
+#include <csignal>
+#include <iostream>
+#include <thread>
+#include "../Source/PluginProcessor.h"
+
+#if JUCE_LINUX
+#include <pthread.h>
+#include <sched.h>
+#include <sys/mman.h>
+#include <time.h>
+#endif
+
+// Runs the effect as a headless service: one processor on a dedicated audio thread, driven by JACK
+// or ALSA when a device opens and otherwise by a clock-paced null backend (silence in, output
+// discarded) or file backend (a file in, the processed file out, in real time). On Linux the
+// audio thread gets SCHED_FIFO where permitted and optional CPU pinning, all memory is locked with
+// mlockall and buffers and stack are touched before the first real callback. Every few seconds it
+// prints callback jitter, the worst processing time and xrun counts. Stops on SIGINT or SIGTERM.
+//
+// AudioDelayDaemon [--backend=auto|jack|alsa|null|file] [--device=<name>] [--input=in.wav] [--output=out.wav]
+//                  [--sample-rate=48000] [--block-size=128] [--preset=0] [--cpu=<n>] [--priority=80]
+//                  [--report-seconds=5] [--duration=<seconds>]
+
+using Clock = std::chrono::steady_clock;
+
+static std::atomic<bool> stopRequested{false};
+
+static void handleStopSignal(int)
+{
+    stopRequested.store(true);
+}
+
+// Written by the audio thread, swapped out by the reporter; one cache line away from everything else
+struct alignas(64) CallbackStats
+{
+    std::atomic<juce::int64> callbacks{0};
+    std::atomic<juce::int64> overruns{0}; // processing took longer than the period
+    std::atomic<juce::int64> missedWakeups{0}; // paced backends only: woke a whole period late
+    std::atomic<juce::int64> totalJitterNanoseconds{0};
+    std::atomic<juce::int64> maxJitterNanoseconds{0};
+    std::atomic<juce::int64> maxProcessNanoseconds{0};
+
+    static void raise(std::atomic<juce::int64> &value, juce::int64 candidate)
+    {
+        auto current = value.load(std::memory_order_relaxed);
+        while (candidate > current && !value.compare_exchange_weak(current, candidate, std::memory_order_relaxed))
+        {
+        }
+    }
+};
+
+struct ThreadSetup
+{
+    std::atomic<bool> done{false};
+    std::atomic<bool> realtime{false};
+    std::atomic<bool> pinned{false};
+};
+
+static bool lockMemory()
+{
+#if JUCE_LINUX
+    return mlockall(MCL_CURRENT | MCL_FUTURE) == 0;
+#else
+    return false;
+#endif
+}
+
+// Touches the stack the callback can grow into, so the first deep call doesn't page-fault
+static void prefaultStack()
+{
+    volatile char stack[128 * 1024];
+    for (size_t i = 0; i < sizeof(stack); i += 4096)
+        stack[i] = 0;
+}
+
+// Runs on the audio thread itself
+static void configureAudioThread(ThreadSetup &setup, int priority, int cpu)
+{
+#if JUCE_LINUX
+    sched_param param{};
+    param.sched_priority = juce::jlimit(sched_get_priority_min(SCHED_FIFO), sched_get_priority_max(SCHED_FIFO), priority);
+    setup.realtime.store(pthread_setschedparam(pthread_self(), SCHED_FIFO, &param) == 0);
+
+    if (cpu >= 0)
+    {
+        cpu_set_t cpus;
+        CPU_ZERO(&cpus);
+        CPU_SET(cpu, &cpus);
+        setup.pinned.store(pthread_setaffinity_np(pthread_self(), sizeof(cpus), &cpus) == 0);
+    }
+#else
+    juce::ignoreUnused(priority, cpu);
+#endif
+
+    prefaultStack();
+    setup.done.store(true);
+}
+
+// Owns the processor and the audio-thread side of every backend
+class DaemonHost : public juce::AudioIODeviceCallback
+{
+public:
+    DaemonHost(AudioDelayAudioProcessor &processorToHost, int priority, int cpu)
+        : processor(processorToHost), threadPriority(priority), threadCpu(cpu)
+    {
+    }
+
+    void prepare(double newSampleRate, int newBlockSize)
+    {
+        sampleRate = newSampleRate;
+        blockSize = newBlockSize;
+        periodNanoseconds = static_cast<juce::int64>(1.0e9 * blockSize / sampleRate);
+
+        processor.setRateAndBufferSizeDetails(sampleRate, blockSize);
+        processor.prepareToPlay(sampleRate, blockSize);
+        buffer.setSize(2, blockSize);
+
+        // A second of silence through the whole chain faults in and warms every buffer prepare allocated
+        for (int block = 0; block < static_cast<int>(sampleRate) / blockSize; ++block)
+        {
+            buffer.clear();
+            processor.processBlock(buffer, midi);
+        }
+        buffer.clear();
+
+        lastCallback = {};
+    }
+
+    // One period on the audio thread; jitter is how far this call's start is from where it should be
+    void process(const float *const *inputs, int numInputs, float *const *outputs, int numOutputs, int numSamples, juce::int64 jitterNanoseconds)
+    {
+        auto start = Clock::now();
+
+        // A device may hand over more than it announced; anything past the prepared size goes through in pieces
+        for (int offset = 0; offset < numSamples; offset += blockSize)
+        {
+            int length = juce::jmin(blockSize, numSamples - offset);
+            juce::AudioBuffer<float> block(buffer.getArrayOfWritePointers(), buffer.getNumChannels(), length);
+
+            for (int channel = 0; channel < block.getNumChannels(); ++channel)
+            {
+                // A mono input feeds both sides
+                const float *source = numInputs > 0 ? inputs[juce::jmin(channel, numInputs - 1)] : nullptr;
+                if (source != nullptr)
+                    block.copyFrom(channel, 0, source + offset, length);
+                else
+                    block.clear(channel, 0, length);
+            }
+
+            processor.processBlock(block, midi);
+
+            for (int channel = 0; channel < numOutputs; ++channel)
+                if (outputs[channel] != nullptr)
+                    juce::FloatVectorOperations::copy(outputs[channel] + offset, block.getReadPointer(juce::jmin(channel, block.getNumChannels() - 1)), length);
+        }
+
+        auto processNanoseconds = std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start).count();
+        auto jitter = std::abs(jitterNanoseconds);
+
+        stats.callbacks.fetch_add(1, std::memory_order_relaxed);
+        stats.totalJitterNanoseconds.fetch_add(jitter, std::memory_order_relaxed);
+        CallbackStats::raise(stats.maxJitterNanoseconds, jitter);
+        CallbackStats::raise(stats.maxProcessNanoseconds, processNanoseconds);
+        if (processNanoseconds > periodNanoseconds)
+            stats.overruns.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    void audioDeviceIOCallbackWithContext(const float *const *inputs, int numInputs, float *const *outputs, int numOutputs, int numSamples,
+                                          const juce::AudioIODeviceCallbackContext &context) override
+    {
+        juce::ignoreUnused(context);
+
+        if (!setup.done.load(std::memory_order_relaxed))
+            configureAudioThread(setup, threadPriority, threadCpu);
+
+        // The device thread has no schedule to compare against, so jitter is the spread of the callback interval
+        auto now = Clock::now();
+        juce::int64 jitter = 0;
+        if (lastCallback != Clock::time_point{})
+            jitter = std::chrono::duration_cast<std::chrono::nanoseconds>(now - lastCallback).count()
+                     - static_cast<juce::int64>(1.0e9 * numSamples / sampleRate);
+        lastCallback = now;
+
+        process(inputs, numInputs, outputs, numOutputs, numSamples, jitter);
+    }
+
+    void audioDeviceAboutToStart(juce::AudioIODevice *device) override
+    {
+        prepare(device->getCurrentSampleRate(), device->getCurrentBufferSizeSamples());
+    }
+
+    void audioDeviceStopped() override
+    {
+        processor.releaseResources();
+    }
+
+    ThreadSetup &getThreadSetup() { return setup; }
+    CallbackStats &getStats() { return stats; }
+    int getThreadPriority() const { return threadPriority; }
+    int getThreadCpu() const { return threadCpu; }
+    double getSampleRate() const { return sampleRate; }
+    int getBlockSize() const { return blockSize; }
+    juce::int64 getPeriodNanoseconds() const { return periodNanoseconds; }
+
+private:
+    AudioDelayAudioProcessor &processor;
+    juce::AudioBuffer<float> buffer;
+    juce::MidiBuffer midi;
+    int threadPriority;
+    int threadCpu;
+    double sampleRate = 48000.0;
+    int blockSize = 128;
+    juce::int64 periodNanoseconds = 0;
+    Clock::time_point lastCallback;
+
+    ThreadSetup setup;
+    CallbackStats stats;
+};
+
+// Null and file backends: a thread of our own that wakes on an absolute schedule, one period apart
+class PacedBackend
+{
+public:
+    // input may be null (silence); output, if given, must be at least as long as input
+    PacedBackend(DaemonHost &hostToDrive, const juce::AudioBuffer<float> *inputAudio, juce::AudioBuffer<float> *outputAudio)
+        : host(hostToDrive), input(inputAudio), output(outputAudio)
+    {
+    }
+
+    ~PacedBackend() { stop(); }
+
+    void start()
+    {
+        thread = std::thread([this]
+                             { run(); });
+    }
+
+    void stop()
+    {
+        running.store(false);
+        if (thread.joinable())
+            thread.join();
+    }
+
+    bool isFinished() const { return finished.load(); }
+    juce::int64 getSamplesRendered() const { return samplesRendered.load(); }
+
+private:
+    void run()
+    {
+        configureAudioThread(host.getThreadSetup(), host.getThreadPriority(), host.getThreadCpu());
+
+        const int blockSize = host.getBlockSize();
+        const auto period = std::chrono::nanoseconds(host.getPeriodNanoseconds());
+        std::vector<float> silence(static_cast<size_t>(blockSize), 0.0f);
+        std::vector<float> discard(static_cast<size_t>(blockSize), 0.0f);
+        const float *silentInputs[2] = {silence.data(), silence.data()};
+        float *discardOutputs[2] = {discard.data(), discard.data()};
+
+        auto deadline = Clock::now();
+        juce::int64 position = 0;
+
+        while (running.load(std::memory_order_relaxed))
+        {
+            deadline += period;
+            sleepUntil(deadline);
+
+            auto jitter = std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - deadline).count();
+
+            // Woke a full period late: that period is lost, as it would be on a device, so the schedule restarts from now
+            if (jitter > host.getPeriodNanoseconds())
+            {
+                host.getStats().missedWakeups.fetch_add(1, std::memory_order_relaxed);
+                deadline = Clock::now();
+            }
+
+            const float *inputs[2] = {silentInputs[0], silentInputs[1]};
+            float *outputs[2] = {discardOutputs[0], discardOutputs[1]};
+            int numSamples = blockSize;
+
+            if (input != nullptr)
+            {
+                numSamples = static_cast<int>(juce::jmin(static_cast<juce::int64>(blockSize), input->getNumSamples() - position));
+                if (numSamples <= 0)
+                    break;
+
+                for (int channel = 0; channel < 2; ++channel)
+                    inputs[channel] = input->getReadPointer(juce::jmin(channel, input->getNumChannels() - 1), static_cast<int>(position));
+            }
+
+            if (output != nullptr)
+                for (int channel = 0; channel < 2; ++channel)
+                    outputs[channel] = output->getWritePointer(juce::jmin(channel, output->getNumChannels() - 1), static_cast<int>(position));
+
+            host.process(inputs, 2, outputs, output != nullptr ? output->getNumChannels() : 2, numSamples, jitter);
+
+            position += numSamples;
+            samplesRendered.store(position, std::memory_order_relaxed);
+        }
+
+        finished.store(true);
+    }
+
+    static void sleepUntil(Clock::time_point deadline)
+    {
+#if JUCE_LINUX
+        // steady_clock is CLOCK_MONOTONIC on Linux; an absolute wake-up doesn't accumulate drift
+        auto since = std::chrono::duration_cast<std::chrono::nanoseconds>(deadline.time_since_epoch()).count();
+        timespec wake{static_cast<time_t>(since / 1000000000), static_cast<long>(since % 1000000000)};
+        while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &wake, nullptr) == EINTR)
+        {
+        }
+#else
+        std::this_thread::sleep_until(deadline);
+#endif
+    }
+
+    DaemonHost &host;
+    const juce::AudioBuffer<float> *input;
+    juce::AudioBuffer<float> *output;
+    std::thread thread;
+    std::atomic<bool> running{true};
+    std::atomic<bool> finished{false};
+    std::atomic<juce::int64> samplesRendered{0};
+};
+
+// Opens JACK, then ALSA (or just the requested one); false if no device would start
+static bool openDevice(juce::AudioDeviceManager &deviceManager, const juce::String &backend, const juce::String &deviceName,
+                       double sampleRate, int blockSize)
+{
+    juce::StringArray types;
+    if (backend == "auto" || backend == "jack")
+        types.add("JACK");
+    if (backend == "auto" || backend == "alsa")
+        types.add("ALSA");
+
+    for (const auto &type : types)
+    {
+        deviceManager.setCurrentAudioDeviceType(type, true);
+        if (deviceManager.getCurrentDeviceTypeObject() == nullptr || deviceManager.getCurrentDeviceTypeObject()->getTypeName() != type)
+            continue;
+
+        auto setup = deviceManager.getAudioDeviceSetup();
+        setup.sampleRate = sampleRate;
+        setup.bufferSize = blockSize;
+        if (deviceName.isNotEmpty())
+            setup.inputDeviceName = setup.outputDeviceName = deviceName;
+
+        auto error = deviceManager.setAudioDeviceSetup(setup, true);
+        if (error.isEmpty() && deviceManager.getCurrentAudioDevice() != nullptr)
+            return true;
+
+        std::cerr << type << ": " << (error.isEmpty() ? juce::String("no device") : error) << std::endl;
+    }
+
+    return false;
+}
+
+static void printReport(DaemonHost &host, juce::AudioIODevice *device, juce::int64 &lastDeviceXRuns)
+{
+    auto &stats = host.getStats();
+    auto callbacks = stats.callbacks.exchange(0);
+    auto totalJitter = stats.totalJitterNanoseconds.exchange(0);
+    auto maxJitter = stats.maxJitterNanoseconds.exchange(0);
+    auto maxProcess = stats.maxProcessNanoseconds.exchange(0);
+    auto overruns = stats.overruns.exchange(0);
+    auto missedWakeups = stats.missedWakeups.exchange(0);
+
+    std::cout << juce::String(callbacks).paddedLeft(' ', 9) << " callbacks"
+              << "   jitter mean " << juce::String(callbacks > 0 ? 1.0e-3 * totalJitter / callbacks : 0.0, 1).paddedLeft(' ', 7) << " us"
+              << " max " << juce::String(1.0e-3 * maxJitter, 1).paddedLeft(' ', 8) << " us"
+              << "   process max " << juce::String(1.0e-3 * maxProcess, 1).paddedLeft(' ', 8) << " us of "
+              << juce::String(1.0e-3 * host.getPeriodNanoseconds(), 1) << "   overruns " << overruns;
+
+    if (device != nullptr)
+    {
+        auto deviceXRuns = static_cast<juce::int64>(device->getXRunCount());
+        if (deviceXRuns >= 0)
+        {
+            std::cout << "   device xruns " << (deviceXRuns - lastDeviceXRuns);
+            lastDeviceXRuns = deviceXRuns;
+        }
+    }
+    else
+    {
+        std::cout << "   missed wake-ups " << missedWakeups;
+    }
+
+    std::cout << std::endl;
+}
+
+int main(int argc, char *argv[])
+{
+    juce::ArgumentList args(argc, argv);
+    juce::ScopedJuceInitialiser_GUI juceInitialiser; // the processor's parameter state and the device manager expect a message manager
+
+    auto backend = args.containsOption("--backend") ? args.getValueForOption("--backend").toLowerCase() : juce::String("auto");
+    if (args.containsOption("--input") && !args.containsOption("--backend"))
+        backend = "file";
+
+    double sampleRate = args.containsOption("--sample-rate") ? args.getValueForOption("--sample-rate").getDoubleValue() : 48000.0;
+    int blockSize = args.containsOption("--block-size") ? args.getValueForOption("--block-size").getIntValue() : 128;
+    int priority = args.containsOption("--priority") ? args.getValueForOption("--priority").getIntValue() : 80;
+    int cpu = args.containsOption("--cpu") ? args.getValueForOption("--cpu").getIntValue() : -1;
+    double reportSeconds = args.containsOption("--report-seconds") ? args.getValueForOption("--report-seconds").getDoubleValue() : 5.0;
+    double duration = args.containsOption("--duration") ? args.getValueForOption("--duration").getDoubleValue() : 0.0;
+    blockSize = juce::jlimit(16, 8192, blockSize);
+    reportSeconds = juce::jmax(0.1, reportSeconds);
+
+    AudioDelayAudioProcessor processor;
+    if (args.containsOption("--preset"))
+        processor.setCurrentProgram(args.getValueForOption("--preset").getIntValue());
+
+    DaemonHost host(processor, priority, cpu);
+
+    juce::AudioBuffer<float> fileInput, fileOutput;
+    if (backend == "file")
+    {
+        juce::AudioFormatManager formatManager;
+        formatManager.registerBasicFormats();
+
+        auto inputFile = args.getFileForOption("--input");
+        std::unique_ptr<juce::AudioFormatReader> reader(formatManager.createReaderFor(inputFile));
+        if (reader == nullptr)
+        {
+            std::cerr << "Could not read " << inputFile.getFullPathName() << std::endl;
+            return 1;
+        }
+
+        // The whole file is read and the output allocated up front, the audio thread only copies
+        int numChannels = juce::jmin(2, static_cast<int>(reader->numChannels));
+        fileInput.setSize(numChannels, static_cast<int>(reader->lengthInSamples));
+        reader->read(&fileInput, 0, fileInput.getNumSamples(), 0, true, numChannels > 1);
+        fileOutput.setSize(numChannels, fileInput.getNumSamples());
+        sampleRate = reader->sampleRate;
+    }
+
+    // Once the processor and file buffers exist, so a tight RLIMIT_MEMLOCK fails here rather than on a later allocation
+    bool memoryLocked = lockMemory();
+
+    juce::AudioDeviceManager deviceManager;
+    juce::AudioIODevice *device = nullptr;
+    std::unique_ptr<PacedBackend> pacedBackend;
+
+    if (backend == "auto" || backend == "jack" || backend == "alsa")
+    {
+        deviceManager.initialiseWithDefaultDevices(2, 2);
+        if (openDevice(deviceManager, backend, args.getValueForOption("--device"), sampleRate, blockSize))
+        {
+            device = deviceManager.getCurrentAudioDevice();
+            deviceManager.addAudioCallback(&host);
+        }
+        else
+        {
+            std::cerr << "No audio device opened, falling back to the null backend" << std::endl;
+            deviceManager.closeAudioDevice();
+            backend = "null";
+        }
+    }
+
+    if (device == nullptr)
+    {
+        host.prepare(sampleRate, blockSize);
+        pacedBackend = std::make_unique<PacedBackend>(host, backend == "file" ? &fileInput : nullptr, backend == "file" ? &fileOutput : nullptr);
+        pacedBackend->start();
+    }
+
+    std::signal(SIGINT, handleStopSignal);
+    std::signal(SIGTERM, handleStopSignal);
+
+    auto &setup = host.getThreadSetup();
+    while (!setup.done.load() && !stopRequested.load())
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+
+    std::cout << "Backend: " << (device != nullptr ? device->getTypeName() + " " + device->getName() : backend)
+              << ", " << host.getSampleRate() << " Hz, block size " << host.getBlockSize() << std::endl
+              << "Memory locked: " << (memoryLocked ? "yes" : "no")
+              << ", SCHED_FIFO: " << (setup.realtime.load() ? "yes, priority " + juce::String(priority) : juce::String("no (needs CAP_SYS_NICE or an rtprio limit)"))
+              << ", pinned: " << (cpu < 0 ? juce::String("not requested") : setup.pinned.load() ? "cpu " + juce::String(cpu) : juce::String("no"))
+              << std::endl;
+
+    auto started = Clock::now();
+    auto nextReport = started;
+    juce::int64 lastDeviceXRuns = device != nullptr ? juce::jmax(0, device->getXRunCount()) : 0;
+
+    while (!stopRequested.load())
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        auto now = Clock::now();
+
+        bool finished = pacedBackend != nullptr && pacedBackend->isFinished();
+        bool timedOut = duration > 0.0 && std::chrono::duration<double>(now - started).count() >= duration;
+
+        if (now >= nextReport || finished || timedOut)
+        {
+            printReport(host, device, lastDeviceXRuns);
+            nextReport = now + std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(reportSeconds));
+        }
+
+        if (finished || timedOut)
+            break;
+    }
+
+    if (device != nullptr)
+    {
+        deviceManager.removeAudioCallback(&host);
+        deviceManager.closeAudioDevice();
+    }
+
+    if (pacedBackend != nullptr)
+        pacedBackend->stop();
+
+    if (backend == "file" && args.containsOption("--output"))
+    {
+        auto outputFile = args.getFileForOption("--output");
+        outputFile.deleteFile();
+
+        juce::WavAudioFormat wavFormat;
+        std::unique_ptr<juce::AudioFormatWriter> writer(wavFormat.createWriterFor(new juce::FileOutputStream(outputFile),
+                                                                                  sampleRate, static_cast<unsigned int>(fileOutput.getNumChannels()), 24, {}, 0));
+        if (writer == nullptr)
+        {
+            std::cerr << "Could not write " << outputFile.getFullPathName() << std::endl;
+            return 1;
+        }
+
+        writer->writeFromAudioSampleBuffer(fileOutput, 0, static_cast<int>(pacedBackend->getSamplesRendered()));
+    }
+
+    return 0;
+}
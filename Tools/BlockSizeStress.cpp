@@ -0,0 +1,262 @@
+#include <juce_audio_formats/juce_audio_formats.h>
+#include <chrono>
+#include <iostream>
+#include <map>
+#include "../Source/DelayEngine.h"
+#include "ParameterOptions.h"
+
+// Renders an audio file through the engine with fixed, random and pathological block size
+// sequences, checks every render against a fixed-size reference and reports the worst
+// per-callback time for each block size. Exits non-zero if any render is out of tolerance.
+// With --compare-isa it also renders the reference once per instruction set the CPU supports
+// and checks each dispatched variant against the baseline one.
+//
+// BlockSizeStress --input=piano.wav [--reference-block-size=64] [--tolerance-db=-80] [--seed=1] [--double] [--compare-isa] [--delay=500 ...]
+
+struct BlockSequence
+{
+    juce::String name;
+    std::vector<int> sizes; // cycled until the file is consumed
+};
+
+struct CallbackTiming
+{
+    int calls = 0;
+    double worstMicroseconds = 0.0;
+    double totalMicroseconds = 0.0;
+};
+
+struct RenderResult
+{
+    juce::AudioBuffer<double> output;
+    std::map<int, CallbackTiming> timings; // keyed by block size
+};
+
+static const int MAX_BLOCK_SIZE = 4096;
+
+template <typename SampleType>
+static RenderResult render(const juce::AudioBuffer<float> &input, double sampleRate, const std::vector<int> &sizes, const DelayParameters &params)
+{
+    juce::AudioBuffer<SampleType> buffer(input.getNumChannels(), input.getNumSamples());
+    for (int channel = 0; channel < input.getNumChannels(); ++channel)
+        for (int sample = 0; sample < input.getNumSamples(); ++sample)
+            buffer.setSample(channel, sample, static_cast<SampleType>(input.getSample(channel, sample)));
+
+    juce::dsp::ProcessSpec spec;
+    spec.sampleRate = sampleRate;
+    spec.maximumBlockSize = static_cast<juce::uint32>(MAX_BLOCK_SIZE);
+    spec.numChannels = static_cast<juce::uint32>(buffer.getNumChannels());
+
+    DelayEngine<SampleType> engine;
+    engine.prepare(spec, params);
+
+    RenderResult result;
+    size_t sequenceIndex = 0;
+
+    for (int start = 0; start < buffer.getNumSamples();)
+    {
+        int numSamples = juce::jmin(sizes[sequenceIndex], buffer.getNumSamples() - start);
+        sequenceIndex = (sequenceIndex + 1) % sizes.size();
+
+        juce::AudioBuffer<SampleType> block(buffer.getArrayOfWritePointers(), buffer.getNumChannels(), start, numSamples);
+
+        auto callbackStart = std::chrono::steady_clock::now();
+        engine.process(block, block.getNumChannels(), params);
+        auto elapsed = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - callbackStart).count();
+
+        auto &timing = result.timings[numSamples];
+        ++timing.calls;
+        timing.totalMicroseconds += elapsed;
+        timing.worstMicroseconds = juce::jmax(timing.worstMicroseconds, elapsed);
+
+        start += numSamples;
+    }
+
+    result.output.setSize(buffer.getNumChannels(), buffer.getNumSamples());
+    for (int channel = 0; channel < buffer.getNumChannels(); ++channel)
+        for (int sample = 0; sample < buffer.getNumSamples(); ++sample)
+            result.output.setSample(channel, sample, static_cast<double>(buffer.getSample(channel, sample)));
+
+    return result;
+}
+
+static std::vector<BlockSequence> buildSequences(juce::Random &random)
+{
+    std::vector<BlockSequence> sequences;
+
+    for (int size = 16; size <= MAX_BLOCK_SIZE; size *= 2)
+        sequences.push_back({"fixed " + juce::String(size), {size}});
+
+    BlockSequence randomSizes{"random 16-4096", {}};
+    for (int i = 0; i < 257; ++i)
+        randomSizes.sizes.push_back(16 + random.nextInt(MAX_BLOCK_SIZE - 16 + 1));
+    sequences.push_back(randomSizes);
+
+    BlockSequence randomSmall{"random 1-64", {}};
+    for (int i = 0; i < 257; ++i)
+        randomSmall.sizes.push_back(1 + random.nextInt(64));
+    sequences.push_back(randomSmall);
+
+    sequences.push_back({"single sample", {1}});
+    sequences.push_back({"primes", {1, 3, 7, 13, 31, 127, 509, 1021, 4093}});
+    sequences.push_back({"alternating 4096/1", {MAX_BLOCK_SIZE, 1}});
+    sequences.push_back({"alternating 1/4095", {1, MAX_BLOCK_SIZE - 1}});
+
+    return sequences;
+}
+
+static double maxDifference(const juce::AudioBuffer<double> &a, const juce::AudioBuffer<double> &b)
+{
+    double difference = 0.0;
+    for (int channel = 0; channel < a.getNumChannels(); ++channel)
+        for (int sample = 0; sample < a.getNumSamples(); ++sample)
+            difference = juce::jmax(difference, std::abs(a.getSample(channel, sample) - b.getSample(channel, sample)));
+    return difference;
+}
+
+int main(int argc, char *argv[])
+{
+    juce::ArgumentList args(argc, argv);
+
+    if (!args.containsOption("--input"))
+    {
+        std::cout << "usage: BlockSizeStress --input=<file> [--reference-block-size=<n>] [--tolerance-db=<dB>] [--seed=<n>] [--double] [--compare-isa] [--<parameter>=<value> ...]" << std::endl;
+        return 1;
+    }
+
+    auto inputFile = args.getFileForOption("--input");
+    int referenceBlockSize = args.containsOption("--reference-block-size") ? args.getValueForOption("--reference-block-size").getIntValue() : 64;
+    double toleranceDb = args.containsOption("--tolerance-db") ? args.getValueForOption("--tolerance-db").getDoubleValue() : -80.0;
+    bool useDouble = args.containsOption("--double");
+    bool compareIsa = args.containsOption("--compare-isa");
+    juce::Random random(args.containsOption("--seed") ? args.getValueForOption("--seed").getLargeIntValue() : 1);
+
+    referenceBlockSize = juce::jlimit(1, MAX_BLOCK_SIZE, referenceBlockSize);
+
+    juce::AudioFormatManager formatManager;
+    formatManager.registerBasicFormats();
+
+    std::unique_ptr<juce::AudioFormatReader> reader(formatManager.createReaderFor(inputFile));
+    if (reader == nullptr)
+    {
+        std::cerr << "Could not read " << inputFile.getFullPathName() << std::endl;
+        return 1;
+    }
+
+    // The engine's DC blockers are stereo, so anything wider is folded down to the first two channels
+    int numChannels = juce::jmin(2, static_cast<int>(reader->numChannels));
+    juce::AudioBuffer<float> input(numChannels, static_cast<int>(reader->lengthInSamples));
+    reader->read(&input, 0, input.getNumSamples(), 0, true, numChannels > 1);
+
+    DelayParameters params;
+    applyParameterOptions(args, params);
+
+    auto renderSequence = [&](const std::vector<int> &sizes)
+    {
+        return useDouble ? render<double>(input, reader->sampleRate, sizes, params)
+                         : render<float>(input, reader->sampleRate, sizes, params);
+    };
+
+    auto reference = renderSequence({referenceBlockSize});
+
+    double peak = 0.0;
+    for (int channel = 0; channel < numChannels; ++channel)
+        for (int sample = 0; sample < reference.output.getNumSamples(); ++sample)
+            peak = juce::jmax(peak, std::abs(reference.output.getSample(channel, sample)));
+
+    std::cout << "Input: " << input.getNumSamples() << " samples at " << reader->sampleRate << " Hz, "
+              << (useDouble ? "double" : "float") << " engine, " << CpuDispatch::getLevelName(CpuDispatch::getLevel()) << " kernels" << std::endl;
+    std::cout << "Reference: fixed " << referenceBlockSize << ", peak " << juce::Decibels::gainToDecibels(peak) << " dBFS, tolerance "
+              << toleranceDb << " dB relative to peak" << std::endl
+              << std::endl;
+
+    bool allPassed = true;
+    std::map<int, CallbackTiming> timingsBySize;
+
+    auto relativeDb = [&](double difference)
+    {
+        return juce::Decibels::gainToDecibels(difference, -300.0) - juce::Decibels::gainToDecibels(peak, -300.0);
+    };
+
+    if (compareIsa)
+    {
+        // Every variant runs the same arithmetic; only FMA contraction and vector width may move the last bits
+        CpuDispatch::setLevelOverride(CpuDispatch::Level::Baseline);
+        auto baseline = renderSequence({referenceBlockSize});
+
+        for (auto level : {CpuDispatch::Level::AVX2, CpuDispatch::Level::AVX512})
+        {
+            if (static_cast<int>(level) > static_cast<int>(CpuDispatch::getSupportedLevel()))
+            {
+                std::cout << "SKIP  " << juce::String(CpuDispatch::getLevelName(level)).paddedRight(' ', 22) << " not supported here" << std::endl;
+                continue;
+            }
+
+            CpuDispatch::setLevelOverride(level);
+            auto variant = renderSequence({referenceBlockSize});
+
+            double differenceDb = relativeDb(maxDifference(baseline.output, variant.output));
+            bool passed = differenceDb <= toleranceDb;
+            allPassed = allPassed && passed;
+
+            std::cout << (passed ? "PASS  " : "FAIL  ") << juce::String(CpuDispatch::getLevelName(level)).paddedRight(' ', 22)
+                      << " max diff " << juce::String(differenceDb, 1).paddedLeft(' ', 7) << " dB against sse2" << std::endl;
+        }
+
+        CpuDispatch::clearLevelOverride();
+        std::cout << std::endl;
+    }
+
+    for (const auto &sequence : buildSequences(random))
+    {
+        auto result = renderSequence(sequence.sizes);
+
+        double differenceDb = relativeDb(maxDifference(reference.output, result.output));
+        bool passed = differenceDb <= toleranceDb;
+        allPassed = allPassed && passed;
+
+        // Worst callback as a fraction of the real-time budget for its block size
+        double worstLoad = 0.0;
+        int worstLoadSize = 0;
+        for (const auto &entry : result.timings)
+        {
+            double budgetMicroseconds = 1.0e6 * entry.first / reader->sampleRate;
+            double load = entry.second.worstMicroseconds / budgetMicroseconds;
+            if (load > worstLoad)
+            {
+                worstLoad = load;
+                worstLoadSize = entry.first;
+            }
+
+            auto &total = timingsBySize[entry.first];
+            total.calls += entry.second.calls;
+            total.totalMicroseconds += entry.second.totalMicroseconds;
+            total.worstMicroseconds = juce::jmax(total.worstMicroseconds, entry.second.worstMicroseconds);
+        }
+
+        std::cout << (passed ? "PASS  " : "FAIL  ") << sequence.name.paddedRight(' ', 22)
+                  << " max diff " << juce::String(differenceDb, 1).paddedLeft(' ', 7) << " dB"
+                  << "   worst callback " << juce::String(worstLoad * 100.0, 1).paddedLeft(' ', 6) << "% of budget at "
+                  << worstLoadSize << " samples" << std::endl;
+    }
+
+    // Random sizes only hit a few times would swamp the table, so leave those out
+    std::cout << std::endl
+              << "Block size   Calls   Mean us   Worst us   Worst % of budget" << std::endl;
+    for (const auto &entry : timingsBySize)
+    {
+        if (entry.second.calls < 4 && !juce::isPowerOfTwo(entry.first))
+            continue;
+
+        double budgetMicroseconds = 1.0e6 * entry.first / reader->sampleRate;
+        std::cout << juce::String(entry.first).paddedLeft(' ', 10)
+                  << juce::String(entry.second.calls).paddedLeft(' ', 8)
+                  << juce::String(entry.second.totalMicroseconds / entry.second.calls, 2).paddedLeft(' ', 10)
+                  << juce::String(entry.second.worstMicroseconds, 2).paddedLeft(' ', 11)
+                  << juce::String(100.0 * entry.second.worstMicroseconds / budgetMicroseconds, 1).paddedLeft(' ', 20) << std::endl;
+    }
+
+    std::cout << std::endl
+              << (allPassed ? "All block sequences match the reference" : "Some block sequences differ from the reference") << std::endl;
+    return allPassed ? 0 : 1;
+}
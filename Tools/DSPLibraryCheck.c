@@ -0,0 +1,206 @@
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include "../Source/AudioDelayDSP.h"
+
+/*
+ * Plain C consumer of the AudioDelayDSP library: builds with a C compiler and links nothing from
+ * JUCE directly, so it doubles as a check that the header and library stand on their own.
+ *
+ * Two engines with the same settings render the same noise burst, one through the interleaved
+ * call in uneven blocks and one through the planar call in blocks longer than max_block_size. Their
+ * outputs must stay finite and agree to within -80 dB of the peak (block boundaries move where the
+ * control-rate updates land, as in BlockSizeStress), and the argument checks must reject bad calls.
+ * In spectral mode an impulse must come out of the dry path exactly the reported latency late, and
+ * the wet repeat of one at the longest delay must come out five seconds (to the hop) after that.
+ *
+ * DSPLibraryCheck [sample_rate] [seconds]
+ */
+
+#define CHANNELS 2
+#define MAX_BLOCK 256
+
+static int failures = 0;
+
+static void expect(int condition, const char *what)
+{
+    if (!condition)
+    {
+        fprintf(stderr, "FAILED: %s\n", what);
+        ++failures;
+    }
+}
+
+static AudioDelayEngine *createEngine(double sampleRate)
+{
+    AudioDelayEngine *engine = audiodelay_create();
+    expect(engine != NULL, "create");
+    if (engine == NULL)
+        exit(1);
+
+    expect(audiodelay_prepare(engine, sampleRate, MAX_BLOCK, CHANNELS) == AUDIODELAY_OK, "prepare");
+    expect(audiodelay_set_parameter(engine, AUDIODELAY_PARAM_DELAY_MS, 180.0f) == AUDIODELAY_OK, "set delay");
+    expect(audiodelay_set_parameter(engine, AUDIODELAY_PARAM_FEEDBACK, 0.6f) == AUDIODELAY_OK, "set feedback");
+    expect(audiodelay_set_parameter(engine, AUDIODELAY_PARAM_SMEAR, 0.4f) == AUDIODELAY_OK, "set smear");
+    expect(audiodelay_set_parameter(engine, AUDIODELAY_PARAM_NETWORK_LINES, 8.0f) == AUDIODELAY_OK, "set network lines");
+    expect(audiodelay_set_mod_route(engine, 0, AUDIODELAY_MOD_SOURCE_LFO2, AUDIODELAY_MOD_DEST_LOWPASS, -0.5f) == AUDIODELAY_OK, "set mod route");
+    return engine;
+}
+
+int main(int argc, char *argv[])
+{
+    double sampleRate = argc > 1 ? atof(argv[1]) : 48000.0;
+    double seconds = argc > 2 ? atof(argv[2]) : 6.0;
+    int numFrames = (int)(sampleRate * seconds);
+
+    /* Room for a five second spectral repeat past the longest hop's latency */
+    if (numFrames < (int)(sampleRate * 5.0) + 8192)
+    {
+        fprintf(stderr, "usage: DSPLibraryCheck [sample_rate] [seconds]\n");
+        return 1;
+    }
+
+    printf("AudioDelayDSP API version %d\n", (int)audiodelay_get_api_version());
+
+    float *interleaved = malloc(sizeof(float) * (size_t)numFrames * CHANNELS);
+    float *left = malloc(sizeof(float) * (size_t)numFrames);
+    float *right = malloc(sizeof(float) * (size_t)numFrames);
+    if (interleaved == NULL || left == NULL || right == NULL)
+        return 1;
+
+    /* Half a second of noise, then silence for the repeats to ring out into */
+    srand(1);
+    for (int frame = 0; frame < numFrames; ++frame)
+    {
+        for (int channel = 0; channel < CHANNELS; ++channel)
+        {
+            float sample = frame < (int)(0.5 * sampleRate) ? 0.25f * (2.0f * (float)rand() / (float)RAND_MAX - 1.0f) : 0.0f;
+            interleaved[frame * CHANNELS + channel] = sample;
+        }
+        left[frame] = interleaved[frame * CHANNELS];
+        right[frame] = interleaved[frame * CHANNELS + 1];
+    }
+
+    AudioDelayEngine *interleavedEngine = createEngine(sampleRate);
+    AudioDelayEngine *planarEngine = createEngine(sampleRate);
+
+    /* Uneven blocks through one call, oversized ones through the other */
+    static const int blockSizes[] = {1, 64, 17, 256, 100, 3};
+    int blockIndex = 0;
+    for (int start = 0; start < numFrames;)
+    {
+        int size = blockSizes[blockIndex++ % 6];
+        if (size > numFrames - start)
+            size = numFrames - start;
+        expect(audiodelay_process_interleaved(interleavedEngine, interleaved + start * CHANNELS, CHANNELS, size) == AUDIODELAY_OK, "process interleaved");
+        start += size;
+    }
+
+    for (int start = 0; start < numFrames; start += 4 * MAX_BLOCK + 5)
+    {
+        int size = numFrames - start < 4 * MAX_BLOCK + 5 ? numFrames - start : 4 * MAX_BLOCK + 5;
+        float *channels[CHANNELS] = {left + start, right + start};
+        expect(audiodelay_process_planar(planarEngine, channels, CHANNELS, size) == AUDIODELAY_OK, "process planar");
+    }
+
+    double worstDifference = 0.0;
+    double peak = 0.0;
+    int finite = 1;
+    for (int frame = 0; frame < numFrames; ++frame)
+    {
+        float planar[CHANNELS] = {left[frame], right[frame]};
+        for (int channel = 0; channel < CHANNELS; ++channel)
+        {
+            float sample = interleaved[frame * CHANNELS + channel];
+            finite = finite && isfinite(sample) && isfinite(planar[channel]);
+            worstDifference = fmax(worstDifference, fabs((double)sample - (double)planar[channel]));
+            peak = fmax(peak, fabs((double)sample));
+        }
+    }
+
+    double differenceDb = 20.0 * log10(fmax(worstDifference, 1.0e-12) / fmax(peak, 1.0e-12));
+    printf("%d frames, peak %.4f, worst interleaved/planar difference %.1f dB relative to peak\n", numFrames, peak, differenceDb);
+    expect(finite, "output is finite");
+    expect(peak > 0.0, "output is not silent");
+    expect(differenceDb <= -80.0, "interleaved and planar output agree");
+
+    /* Spectral mode delays everything by its frame, and says so */
+    AudioDelayEngine *spectralEngine = createEngine(sampleRate);
+    int32_t latency = -1;
+    expect(audiodelay_set_parameter(spectralEngine, AUDIODELAY_PARAM_SPECTRAL, 1.0f) == AUDIODELAY_OK, "set spectral");
+    expect(audiodelay_set_parameter(spectralEngine, AUDIODELAY_PARAM_SPECTRAL_HOP, 512.0f) == AUDIODELAY_OK, "set spectral hop");
+    expect(audiodelay_get_latency(spectralEngine, &latency) == AUDIODELAY_OK && latency == 2048, "spectral latency");
+
+    int impulseFrames = (int)latency + MAX_BLOCK;
+    for (int frame = 0; frame < impulseFrames; ++frame)
+        left[frame] = right[frame] = frame == 0 ? 1.0f : 0.0f;
+    for (int start = 0; start < impulseFrames; start += MAX_BLOCK)
+    {
+        float *channels[CHANNELS] = {left + start, right + start};
+        expect(audiodelay_process_planar(spectralEngine, channels, CHANNELS, MAX_BLOCK) == AUDIODELAY_OK, "process spectral");
+    }
+
+    int loudestFrame = 0;
+    for (int frame = 0; frame < impulseFrames; ++frame)
+        if (fabs(left[frame]) > fabs(left[loudestFrame]))
+            loudestFrame = frame;
+    printf("spectral latency %d samples, dry impulse out at %d\n", (int)latency, loudestFrame);
+    expect(loudestFrame == latency, "dry path delayed by the reported latency");
+    expect(audiodelay_set_parameter(spectralEngine, AUDIODELAY_PARAM_SPECTRAL_HOP, 300.0f) == AUDIODELAY_ERROR_INVALID_ARGUMENT, "hop not a power of two");
+
+    /* The spectral history reaches the top of the delay range: fully wet, one repeat, no smear */
+    AudioDelayEngine *longEngine = createEngine(sampleRate);
+    expect(audiodelay_set_parameter(longEngine, AUDIODELAY_PARAM_SPECTRAL, 1.0f) == AUDIODELAY_OK, "set spectral");
+    expect(audiodelay_set_parameter(longEngine, AUDIODELAY_PARAM_SPECTRAL_HOP, 512.0f) == AUDIODELAY_OK, "set spectral hop");
+    expect(audiodelay_set_parameter(longEngine, AUDIODELAY_PARAM_DELAY_MS, 5000.0f) == AUDIODELAY_OK, "set longest delay");
+    expect(audiodelay_set_parameter(longEngine, AUDIODELAY_PARAM_FEEDBACK, 0.0f) == AUDIODELAY_OK, "set no feedback");
+    expect(audiodelay_set_parameter(longEngine, AUDIODELAY_PARAM_SMEAR, 0.0f) == AUDIODELAY_OK, "set no smear");
+    expect(audiodelay_set_parameter(longEngine, AUDIODELAY_PARAM_MIX, 1.0f) == AUDIODELAY_OK, "set fully wet");
+
+    int longFrames = numFrames / MAX_BLOCK * MAX_BLOCK;
+    for (int frame = 0; frame < longFrames; ++frame)
+        left[frame] = right[frame] = frame == 0 ? 1.0f : 0.0f;
+    for (int start = 0; start < longFrames; start += MAX_BLOCK)
+    {
+        float *channels[CHANNELS] = {left + start, right + start};
+        expect(audiodelay_process_planar(longEngine, channels, CHANNELS, MAX_BLOCK) == AUDIODELAY_OK, "process long spectral");
+    }
+
+    /* Skip the first second: the engine starts out of spectral mode at half mix, so a little of the
+       dry impulse gets through while both ramp over */
+    int repeatFrame = (int)sampleRate;
+    for (int frame = repeatFrame; frame < longFrames; ++frame)
+        if (fabs(left[frame]) > fabs(left[repeatFrame]))
+            repeatFrame = frame;
+    int expectedFrame = (int)latency + (int)(sampleRate * 5.0);
+    printf("five second spectral repeat out at %d, expected %d\n", repeatFrame, expectedFrame);
+    expect(abs(repeatFrame - expectedFrame) <= 512 && fabs(left[repeatFrame]) > 0.1, "spectral delay reaches five seconds");
+
+    /* Bad calls are refused without touching the engine */
+    float value = 0.0f;
+    AudioDelayEngine *unprepared = audiodelay_create();
+    expect(audiodelay_process_interleaved(unprepared, interleaved, CHANNELS, 16) == AUDIODELAY_ERROR_NOT_PREPARED, "process before prepare");
+    expect(audiodelay_prepare(unprepared, 48000.0, MAX_BLOCK, 3) == AUDIODELAY_ERROR_INVALID_ARGUMENT, "three channels");
+    expect(audiodelay_set_parameter(planarEngine, AUDIODELAY_PARAM_FEEDBACK, 1.5f) == AUDIODELAY_ERROR_INVALID_ARGUMENT, "feedback out of range");
+    expect(audiodelay_set_parameter(planarEngine, AUDIODELAY_PARAM_MIX, NAN) == AUDIODELAY_ERROR_INVALID_ARGUMENT, "NaN value");
+    expect(audiodelay_set_parameter(planarEngine, (AudioDelayParameter)999, 0.0f) == AUDIODELAY_ERROR_UNKNOWN_PARAMETER, "unknown parameter");
+    expect(audiodelay_get_parameter(planarEngine, AUDIODELAY_PARAM_FEEDBACK, &value) == AUDIODELAY_OK && value == 0.6f, "feedback kept");
+    expect(audiodelay_process_planar(planarEngine, NULL, CHANNELS, 16) == AUDIODELAY_ERROR_INVALID_ARGUMENT, "null channels");
+    expect(audiodelay_process_interleaved(planarEngine, interleaved, 1, 16) == AUDIODELAY_ERROR_INVALID_ARGUMENT, "channel count mismatch");
+
+    audiodelay_destroy(unprepared);
+    audiodelay_destroy(interleavedEngine);
+    audiodelay_destroy(planarEngine);
+    audiodelay_destroy(spectralEngine);
+    audiodelay_destroy(longEngine);
+    audiodelay_destroy(NULL);
+    free(interleaved);
+    free(left);
+    free(right);
+
+    if (failures == 0)
+        printf("All checks passed\n");
+    else
+        printf("%d checks failed\n", failures);
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,259 @@
+#include <juce_audio_processors/juce_audio_processors.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <thread>
+#include <vector>
+#include "../Source/PluginProcessor.h"
+
+// Simulates a large session: N plugin instances, each on its own track with a different preset,
+// processed every cycle by a pool of worker threads that pull tracks off a shared counter, the way
+// a host's audio graph spreads independent tracks over cores. Every cycle has a deadline of one
+// buffer. Reports the deadline-miss rate, real-time instances per core and scaling efficiency
+// against a single thread for each instance and thread count.
+//
+// Tracks that share a preset see the same input, so they must end every run with identical output;
+// any difference means state is leaking between instances. Cycles run back to back rather than
+// paced by a clock, so a miss is a cycle whose compute time alone exceeded the buffer.
+//
+// ManyInstanceBench [--instances=1,16,64,200] [--threads=1,2,4,8] [--block-size=256] [--sample-rate=48000] [--seconds=10]
+
+struct Track
+{
+    std::unique_ptr<AudioDelayAudioProcessor> processor;
+    juce::AudioBuffer<float> buffer;
+    juce::MidiBuffer midi;
+    int preset = 0;
+};
+
+// The calling thread runs tracks too, like a host's audio callback thread joining its own graph
+class TrackPool
+{
+public:
+    TrackPool(std::vector<Track> &tracksToRun, const juce::AudioBuffer<float> &inputBlock, int numThreads)
+        : tracks(tracksToRun), input(inputBlock)
+    {
+        for (int i = 1; i < numThreads; ++i)
+            workers.emplace_back([this]
+                                 { workerLoop(); });
+    }
+
+    ~TrackPool()
+    {
+        quit.store(true);
+        for (auto &worker : workers)
+            worker.join();
+    }
+
+    // Returns once every track has processed one block
+    void runCycle()
+    {
+        // Done is cleared before the counter so a worker still leaving the last cycle can't lose a count
+        tracksDone.store(0);
+        nextTrack.store(0);
+        generation.fetch_add(1, std::memory_order_release);
+
+        drain();
+
+        while (tracksDone.load(std::memory_order_acquire) < static_cast<int>(tracks.size()))
+            std::this_thread::yield();
+    }
+
+private:
+    void workerLoop()
+    {
+        int seenGeneration = 0;
+
+        while (!quit.load(std::memory_order_relaxed))
+        {
+            int current = generation.load(std::memory_order_acquire);
+            if (current == seenGeneration)
+            {
+                std::this_thread::yield();
+                continue;
+            }
+
+            seenGeneration = current;
+            drain();
+        }
+    }
+
+    void drain()
+    {
+        for (int index = nextTrack.fetch_add(1); index < static_cast<int>(tracks.size()); index = nextTrack.fetch_add(1))
+        {
+            auto &track = tracks[static_cast<size_t>(index)];
+            for (int channel = 0; channel < track.buffer.getNumChannels(); ++channel)
+                track.buffer.copyFrom(channel, 0, input, channel, 0, input.getNumSamples());
+
+            track.processor->processBlock(track.buffer, track.midi);
+            tracksDone.fetch_add(1, std::memory_order_release);
+        }
+    }
+
+    std::vector<Track> &tracks;
+    const juce::AudioBuffer<float> &input;
+    std::vector<std::thread> workers;
+
+    // Each counter on its own cache line so the harness doesn't add false sharing of its own
+    alignas(64) std::atomic<int> generation{0};
+    alignas(64) std::atomic<int> nextTrack{0};
+    alignas(64) std::atomic<int> tracksDone{0};
+    alignas(64) std::atomic<bool> quit{false};
+};
+
+struct RunResult
+{
+    double meanMicroseconds = 0.0;
+    double p99Microseconds = 0.0;
+    double worstMicroseconds = 0.0;
+    double missRate = 0.0;
+    double realtimeInstancesPerCore = 0.0; // instances one core could keep up with at this load
+    bool isolated = true;
+};
+
+static std::vector<int> parseList(const juce::ArgumentList &args, const char *option, std::vector<int> defaults)
+{
+    if (!args.containsOption(option))
+        return defaults;
+
+    std::vector<int> values;
+    for (const auto &token : juce::StringArray::fromTokens(args.getValueForOption(option), ",", ""))
+        if (token.getIntValue() > 0)
+            values.push_back(token.getIntValue());
+    return values.empty() ? defaults : values;
+}
+
+static std::vector<Track> createTracks(int numInstances, double sampleRate, int blockSize)
+{
+    std::vector<Track> tracks(static_cast<size_t>(numInstances));
+
+    for (int index = 0; index < numInstances; ++index)
+    {
+        auto &track = tracks[static_cast<size_t>(index)];
+        track.processor = std::make_unique<AudioDelayAudioProcessor>();
+        track.preset = index % track.processor->getNumPrograms();
+        track.processor->setCurrentProgram(track.preset);
+        track.processor->setRateAndBufferSizeDetails(sampleRate, blockSize);
+        track.processor->prepareToPlay(sampleRate, blockSize);
+        track.buffer.setSize(2, blockSize);
+    }
+
+    return tracks;
+}
+
+static RunResult run(std::vector<Track> &tracks, const juce::AudioBuffer<float> &input, int numThreads, int numCycles, double budgetMicroseconds)
+{
+    TrackPool pool(tracks, input, numThreads);
+
+    // Let delay lines fill and caches settle before timing
+    for (int cycle = 0; cycle < numCycles / 10; ++cycle)
+        pool.runCycle();
+
+    std::vector<double> cycleTimes;
+    cycleTimes.reserve(static_cast<size_t>(numCycles));
+
+    auto runStart = std::chrono::steady_clock::now();
+    for (int cycle = 0; cycle < numCycles; ++cycle)
+    {
+        auto cycleStart = std::chrono::steady_clock::now();
+        pool.runCycle();
+        cycleTimes.push_back(std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - cycleStart).count());
+    }
+    double wallMicroseconds = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - runStart).count();
+
+    RunResult result;
+    int misses = 0;
+    for (auto time : cycleTimes)
+    {
+        result.meanMicroseconds += time;
+        result.worstMicroseconds = std::max(result.worstMicroseconds, time);
+        misses += time > budgetMicroseconds ? 1 : 0;
+    }
+    result.meanMicroseconds /= numCycles;
+    result.missRate = static_cast<double>(misses) / numCycles;
+
+    std::sort(cycleTimes.begin(), cycleTimes.end());
+    result.p99Microseconds = cycleTimes[static_cast<size_t>(0.99 * (numCycles - 1))];
+
+    double audioMicroseconds = budgetMicroseconds * numCycles * static_cast<double>(tracks.size());
+    result.realtimeInstancesPerCore = audioMicroseconds / wallMicroseconds / numThreads;
+
+    // The first track with each preset is the reference for the rest
+    for (const auto &track : tracks)
+    {
+        const auto &reference = tracks[static_cast<size_t>(track.preset)].buffer;
+        for (int channel = 0; channel < track.buffer.getNumChannels(); ++channel)
+            if (!std::equal(reference.getReadPointer(channel), reference.getReadPointer(channel) + reference.getNumSamples(), track.buffer.getReadPointer(channel)))
+                result.isolated = false;
+    }
+
+    return result;
+}
+
+int main(int argc, char *argv[])
+{
+    juce::ArgumentList args(argc, argv);
+    juce::ScopedJuceInitialiser_GUI juceInitialiser; // the processor's parameter state expects a message manager
+
+    int hardwareThreads = static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+    std::vector<int> defaultThreads;
+    for (int threads = 1; threads <= hardwareThreads; threads *= 2)
+        defaultThreads.push_back(threads);
+
+    auto instanceCounts = parseList(args, "--instances", {1, 16, 64, 200});
+    auto threadCounts = parseList(args, "--threads", defaultThreads);
+    int blockSize = args.containsOption("--block-size") ? args.getValueForOption("--block-size").getIntValue() : 256;
+    double sampleRate = args.containsOption("--sample-rate") ? args.getValueForOption("--sample-rate").getDoubleValue() : 48000.0;
+    double seconds = args.containsOption("--seconds") ? args.getValueForOption("--seconds").getDoubleValue() : 10.0;
+
+    blockSize = juce::jlimit(16, 8192, blockSize);
+    int numCycles = juce::jmax(100, static_cast<int>(seconds * sampleRate / blockSize));
+    double budgetMicroseconds = 1.0e6 * blockSize / sampleRate;
+
+    // Noise at -12 dBFS keeps every stage busy; the same block is fed to every track each cycle
+    juce::AudioBuffer<float> input(2, blockSize);
+    juce::Random random(1);
+    for (int channel = 0; channel < input.getNumChannels(); ++channel)
+        for (int sample = 0; sample < blockSize; ++sample)
+            input.setSample(channel, sample, 0.25f * (2.0f * random.nextFloat() - 1.0f));
+
+    std::cout << hardwareThreads << " hardware threads, block size " << blockSize << " at " << sampleRate << " Hz, deadline "
+              << juce::String(budgetMicroseconds, 1) << " us, " << numCycles << " cycles per run" << std::endl
+              << std::endl
+              << "Instances  Threads   Mean us    p99 us   Worst us   Miss %   RT inst/core   Efficiency   Isolation" << std::endl;
+
+    bool allIsolated = true;
+
+    for (int numInstances : instanceCounts)
+    {
+        auto tracks = createTracks(numInstances, sampleRate, blockSize);
+        double singleThreadPerCore = 0.0;
+
+        for (int numThreads : threadCounts)
+        {
+            auto result = run(tracks, input, numThreads, numCycles, budgetMicroseconds);
+            allIsolated = allIsolated && result.isolated;
+
+            if (numThreads == 1)
+                singleThreadPerCore = result.realtimeInstancesPerCore;
+
+            juce::String efficiency = singleThreadPerCore > 0.0 ? juce::String(100.0 * result.realtimeInstancesPerCore / singleThreadPerCore, 1) + "%" : juce::String("-");
+
+            std::cout << juce::String(numInstances).paddedLeft(' ', 9)
+                      << juce::String(numThreads).paddedLeft(' ', 9)
+                      << juce::String(result.meanMicroseconds, 1).paddedLeft(' ', 10)
+                      << juce::String(result.p99Microseconds, 1).paddedLeft(' ', 10)
+                      << juce::String(result.worstMicroseconds, 1).paddedLeft(' ', 11)
+                      << juce::String(100.0 * result.missRate, 2).paddedLeft(' ', 9)
+                      << juce::String(result.realtimeInstancesPerCore, 1).paddedLeft(' ', 15)
+                      << efficiency.paddedLeft(' ', 13)
+                      << juce::String(result.isolated ? "ok" : "MISMATCH").paddedLeft(' ', 12) << std::endl;
+        }
+    }
+
+    std::cout << std::endl
+              << (allIsolated ? "Instances with the same preset produced identical output" : "Instances with the same preset diverged: state is shared between instances") << std::endl;
+    return allIsolated ? 0 : 1;
+}
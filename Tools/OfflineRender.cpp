@@ -0,0 +1,116 @@
+#include <juce_audio_formats/juce_audio_formats.h>
+#include <iostream>
+#include "../Source/DelayEngine.h"
+#include "../Source/FastMath.h"
+#include "ParameterOptions.h"
+
+// Renders an audio file through the float and double engines and reports how far apart they are.
+//
+// OfflineRender --input=piano.wav [--output=out.wav] [--block-size=512] [--delay=500 --feedback=0.5 ...]
+
+template <typename SampleType>
+static juce::AudioBuffer<SampleType> render(const juce::AudioBuffer<float> &input, double sampleRate, int blockSize, const DelayParameters &params)
+{
+    juce::AudioBuffer<SampleType> output;
+    output.makeCopyOf(input);
+
+    juce::dsp::ProcessSpec spec;
+    spec.sampleRate = sampleRate;
+    spec.maximumBlockSize = static_cast<juce::uint32>(blockSize);
+    spec.numChannels = static_cast<juce::uint32>(output.getNumChannels());
+
+    DelayEngine<SampleType> engine;
+    engine.prepare(spec, params);
+
+    // Spectral mode delays the whole output; render that much further and drop it from the front,
+    // as a host's delay compensation would, so the file lines up with the input
+    const int latency = engine.getLatencySamples();
+    output.setSize(output.getNumChannels(), input.getNumSamples() + latency, true, true);
+
+    for (int start = 0; start < output.getNumSamples(); start += blockSize)
+    {
+        int numSamples = juce::jmin(blockSize, output.getNumSamples() - start);
+        juce::AudioBuffer<SampleType> block(output.getArrayOfWritePointers(), output.getNumChannels(), start, numSamples);
+        engine.process(block, block.getNumChannels(), params);
+    }
+
+    if (latency == 0)
+        return output;
+
+    juce::AudioBuffer<SampleType> aligned(output.getNumChannels(), input.getNumSamples());
+    for (int channel = 0; channel < output.getNumChannels(); ++channel)
+        aligned.copyFrom(channel, 0, output, channel, latency, input.getNumSamples());
+    return aligned;
+}
+
+int main(int argc, char *argv[])
+{
+    juce::ArgumentList args(argc, argv);
+
+    if (!args.containsOption("--input"))
+    {
+        std::cout << "usage: OfflineRender --input=<file> [--output=<file>] [--block-size=<n>] [--<parameter>=<value> ...]" << std::endl;
+        return 1;
+    }
+
+    auto inputFile = args.getFileForOption("--input");
+    int blockSize = args.containsOption("--block-size") ? args.getValueForOption("--block-size").getIntValue() : 512;
+
+    juce::AudioFormatManager formatManager;
+    formatManager.registerBasicFormats();
+
+    std::unique_ptr<juce::AudioFormatReader> reader(formatManager.createReaderFor(inputFile));
+    if (reader == nullptr)
+    {
+        std::cerr << "Could not read " << inputFile.getFullPathName() << std::endl;
+        return 1;
+    }
+
+    // The engine's DC blockers are stereo, so anything wider is folded down to the first two channels
+    int numChannels = juce::jmin(2, static_cast<int>(reader->numChannels));
+    juce::AudioBuffer<float> input(numChannels, static_cast<int>(reader->lengthInSamples));
+    reader->read(&input, 0, input.getNumSamples(), 0, true, numChannels > 1);
+
+    DelayParameters params;
+    applyParameterOptions(args, params);
+
+    auto floatOutput = render<float>(input, reader->sampleRate, blockSize, params);
+    auto doubleOutput = render<double>(input, reader->sampleRate, blockSize, params);
+
+    double maxDifference = 0.0;
+    double peak = 0.0;
+    for (int channel = 0; channel < numChannels; ++channel)
+    {
+        for (int sample = 0; sample < floatOutput.getNumSamples(); ++sample)
+        {
+            double reference = doubleOutput.getSample(channel, sample);
+            maxDifference = juce::jmax(maxDifference, std::abs(reference - static_cast<double>(floatOutput.getSample(channel, sample))));
+            peak = juce::jmax(peak, std::abs(reference));
+        }
+    }
+
+    std::cout << "Rendered " << floatOutput.getNumSamples() << " samples at " << reader->sampleRate << " Hz, block size " << blockSize
+              << ", " << FastMath::name << std::endl;
+    std::cout << "Peak (double): " << juce::Decibels::gainToDecibels(peak) << " dBFS" << std::endl;
+    std::cout << "Max float/double difference: " << maxDifference
+              << " (" << juce::Decibels::gainToDecibels(maxDifference, -300.0) << " dBFS)" << std::endl;
+
+    if (args.containsOption("--output"))
+    {
+        auto outputFile = args.getFileForOption("--output");
+        outputFile.deleteFile();
+
+        juce::WavAudioFormat wavFormat;
+        std::unique_ptr<juce::AudioFormatWriter> writer(wavFormat.createWriterFor(new juce::FileOutputStream(outputFile),
+                                                                                  reader->sampleRate, static_cast<unsigned int>(numChannels), 24, {}, 0));
+        if (writer == nullptr)
+        {
+            std::cerr << "Could not write " << outputFile.getFullPathName() << std::endl;
+            return 1;
+        }
+
+        writer->writeFromAudioSampleBuffer(floatOutput, 0, floatOutput.getNumSamples());
+    }
+
+    return 0;
+}
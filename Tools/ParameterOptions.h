@@ -0,0 +1,67 @@
+#pragma once
+
+#include <juce_core/juce_core.h>
+#include "../Source/DelayEngine.h"
+
+// Shared by the console tools: reads --<parameter>=<value> options over the plugin defaults. Switches
+// also take the bare form, so --reverse is the same as --reverse=1.
+inline void applyParameterOptions(const juce::ArgumentList &args, DelayParameters &params)
+{
+    auto readFloat = [&args](const char *option, float &value)
+    {
+        if (args.containsOption(option))
+            value = args.getValueForOption(option).getFloatValue();
+    };
+    auto readInt = [&args](const char *option, int &value)
+    {
+        if (args.containsOption(option))
+            value = args.getValueForOption(option).getIntValue();
+    };
+    auto readBool = [&args](const char *option, bool &value)
+    {
+        if (args.containsOption(option))
+        {
+            auto text = args.getValueForOption(option);
+            value = text.isEmpty() || text.getIntValue() != 0;
+        }
+    };
+
+    readFloat("--delay", params.delay);
+    readFloat("--feedback", params.feedback);
+    readFloat("--mix", params.mix);
+    readFloat("--bitcrush", params.bitcrush);
+    readFloat("--stereo-width", params.stereoWidth);
+    readFloat("--pan", params.pan);
+    readFloat("--highpass", params.highpassFreq);
+    readFloat("--lowpass", params.lowpassFreq);
+    readFloat("--lfo-freq", params.lfoFreq);
+    readFloat("--lfo-amount", params.lfoAmount);
+    readFloat("--smear", params.smear);
+    readFloat("--waveshape", params.waveshapeAmount);
+    readFloat("--shimmer", params.shimmer);
+    readFloat("--shimmer-pitch", params.shimmerPitch);
+    readBool("--lfo-bitcrush", params.lfoBitcrush);
+    readBool("--lfo-highpass", params.lfoHighpass);
+    readBool("--lfo-lowpass", params.lfoLowpass);
+    readBool("--lfo-pan", params.lfoPan);
+    readBool("--lfo-delay", params.lfoDelay);
+    readBool("--delay-jump", params.delayJump);
+    readBool("--reverse", params.reverse);
+    readBool("--freeze", params.freeze);
+
+    // Matrix routes by index: --mod1-source=2 --mod1-destination=6 --mod1-depth=0.5 (see ModulationRoute)
+    readFloat("--lfo2-freq", params.lfo2Freq);
+    for (int slot = 0; slot < ModulationRoute::MAX_ROUTES; ++slot)
+    {
+        auto prefix = "--mod" + juce::String(slot + 1);
+        auto &route = params.modRoutes[static_cast<size_t>(slot)];
+        readInt((prefix + "-source").toRawUTF8(), route.source);
+        readInt((prefix + "-destination").toRawUTF8(), route.destination);
+        readFloat((prefix + "-depth").toRawUTF8(), route.depth);
+    }
+    readInt("--fdn-lines", params.fdnLines);
+    readInt("--filter-slope", params.filterSlope);
+    readBool("--spectral", params.spectral);
+    readInt("--spectral-hop", params.spectralHop);
+    readFloat("--spectral-tilt", params.spectralTilt);
+}
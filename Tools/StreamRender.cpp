@@ -0,0 +1,315 @@
+#include <juce_audio_formats/juce_audio_formats.h>
+#include <chrono>
+#include <condition_variable>
+#include <iostream>
+#include <mutex>
+#include <thread>
+#include "../Source/DelayEngine.h"
+#include "ParameterOptions.h"
+
+// Renders a file of any length through the float engine with constant memory. A reader thread
+// decodes chunks straight into a fixed ring of buffers, the calling thread processes each chunk in
+// place and a writer thread writes it out from the same buffer, so the three overlap and nothing
+// is allocated or copied per chunk. WAV and AIFF input is read through a memory-mapped window that
+// slides along the file; other formats fall back to a streamed reader.
+//
+// Each stage's busy and waiting time is reported: the stage with the most busy time is the
+// bottleneck, and the others spend the difference waiting on it. Chunks are whole numbers of
+// blocks, so the output matches OfflineRender's float render at the same block size.
+//
+// StreamRender --input=long.wav [--output=out.wav] [--block-size=512] [--chunk-size=16384] [--queue=8] [--bits=24] [--delay=500 ...]
+
+struct Chunk
+{
+    juce::AudioBuffer<float> buffer;
+    int numSamples = 0;
+};
+
+// Bounded queue between the three stages. Chunk n lives in slot n % size; each stage counts the
+// chunks it has finished, and may start chunk n once the stage before has finished it (or, for the
+// reader, once the writer has finished the chunk that last used the slot).
+class ChunkPipeline
+{
+public:
+    enum Stage
+    {
+        Read,
+        Process,
+        Write,
+        NumStages
+    };
+
+    ChunkPipeline(int numSlots, int numChannels, int chunkSize)
+        : slots(static_cast<size_t>(numSlots))
+    {
+        for (auto &slot : slots)
+            slot.buffer.setSize(numChannels, chunkSize);
+    }
+
+    // Null once the pipeline has been aborted
+    Chunk *acquire(Stage stage, juce::int64 chunkIndex)
+    {
+        auto waitStart = std::chrono::steady_clock::now();
+        std::unique_lock<std::mutex> lock(mutex);
+
+        auto numSlots = static_cast<juce::int64>(slots.size());
+        changed.wait(lock, [&]
+                     { return aborted || (stage == Read ? chunkIndex - finished[Write] < numSlots : finished[stage - 1] > chunkIndex); });
+
+        waitSeconds[stage] += std::chrono::duration<double>(std::chrono::steady_clock::now() - waitStart).count();
+        return aborted ? nullptr : &slots[static_cast<size_t>(chunkIndex % numSlots)];
+    }
+
+    void release(Stage stage)
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            ++finished[stage];
+        }
+        changed.notify_all();
+    }
+
+    void abort()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            aborted = true;
+        }
+        changed.notify_all();
+    }
+
+    size_t getBufferBytes() const
+    {
+        return slots.size() * sizeof(float) * static_cast<size_t>(slots[0].buffer.getNumChannels()) * static_cast<size_t>(slots[0].buffer.getNumSamples());
+    }
+
+    // Only read once the stages have finished
+    double waitSeconds[NumStages] = {};
+
+private:
+    std::vector<Chunk> slots;
+    std::mutex mutex;
+    std::condition_variable changed;
+    juce::int64 finished[NumStages] = {};
+    bool aborted = false;
+};
+
+// Mapped readers only decode samples inside the mapped section, so the window is moved ahead of the
+// reads; pages behind it are unmapped and memory stays at one window whatever the file length
+class StreamReader
+{
+public:
+    StreamReader(const juce::File &file, juce::AudioFormatManager &formatManager)
+    {
+        if (file.hasFileExtension("wav;wave"))
+            mappedReader.reset(juce::WavAudioFormat().createMemoryMappedReader(file));
+        else if (file.hasFileExtension("aif;aiff"))
+            mappedReader.reset(juce::AiffAudioFormat().createMemoryMappedReader(file));
+
+        if (mappedReader == nullptr)
+            streamedReader.reset(formatManager.createReaderFor(file));
+    }
+
+    juce::AudioFormatReader *get() const { return mappedReader != nullptr ? mappedReader.get() : streamedReader.get(); }
+    bool isMapped() const { return mappedReader != nullptr; }
+
+    bool read(juce::AudioBuffer<float> &buffer, int numChannels, juce::int64 start, int numSamples, juce::int64 windowSamples)
+    {
+        if (mappedReader != nullptr)
+        {
+            juce::Range<juce::int64> needed(start, start + numSamples);
+            if (!mappedReader->getMappedSection().contains(needed))
+            {
+                auto end = juce::jmin(mappedReader->lengthInSamples, start + juce::jmax(windowSamples, static_cast<juce::int64>(numSamples)));
+                if (!mappedReader->mapSectionOfFile({start, end}))
+                    return false;
+            }
+        }
+
+        return get()->read(&buffer, 0, numSamples, start, true, numChannels > 1);
+    }
+
+private:
+    std::unique_ptr<juce::MemoryMappedAudioFormatReader> mappedReader;
+    std::unique_ptr<juce::AudioFormatReader> streamedReader;
+};
+
+static double secondsSince(std::chrono::steady_clock::time_point start)
+{
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+int main(int argc, char *argv[])
+{
+    juce::ArgumentList args(argc, argv);
+
+    if (!args.containsOption("--input"))
+    {
+        std::cout << "usage: StreamRender --input=<file> [--output=<file>] [--block-size=<n>] [--chunk-size=<n>] [--queue=<n>] [--bits=16|24|32] [--<parameter>=<value> ...]" << std::endl;
+        return 1;
+    }
+
+    auto inputFile = args.getFileForOption("--input");
+    int blockSize = juce::jlimit(1, 65536, args.containsOption("--block-size") ? args.getValueForOption("--block-size").getIntValue() : 512);
+    int chunkSize = juce::jmax(1, args.containsOption("--chunk-size") ? args.getValueForOption("--chunk-size").getIntValue() : 16384);
+    int numSlots = juce::jlimit(2, 256, args.containsOption("--queue") ? args.getValueForOption("--queue").getIntValue() : 8);
+    int bits = args.containsOption("--bits") ? args.getValueForOption("--bits").getIntValue() : 24;
+
+    // Whole blocks per chunk, so the engine sees the same calls as a single-buffer render
+    chunkSize = (chunkSize + blockSize - 1) / blockSize * blockSize;
+
+    juce::AudioFormatManager formatManager;
+    formatManager.registerBasicFormats();
+
+    StreamReader reader(inputFile, formatManager);
+    if (reader.get() == nullptr)
+    {
+        std::cerr << "Could not read " << inputFile.getFullPathName() << std::endl;
+        return 1;
+    }
+
+    double sampleRate = reader.get()->sampleRate;
+    juce::int64 lengthInSamples = reader.get()->lengthInSamples;
+    juce::int64 numChunks = (lengthInSamples + chunkSize - 1) / chunkSize;
+
+    // The engine's DC blockers are stereo, so anything wider is folded down to the first two channels
+    int numChannels = juce::jmin(2, static_cast<int>(reader.get()->numChannels));
+
+    // The mapped window spans 16 chunks from the one being read and moves on once they are used up
+    juce::int64 windowSamples = 16 * static_cast<juce::int64>(chunkSize);
+
+    std::unique_ptr<juce::AudioFormatWriter> writer;
+    if (args.containsOption("--output"))
+    {
+        auto outputFile = args.getFileForOption("--output");
+        outputFile.deleteFile();
+
+        juce::WavAudioFormat wavFormat;
+        writer.reset(wavFormat.createWriterFor(new juce::FileOutputStream(outputFile), sampleRate, static_cast<unsigned int>(numChannels), bits, {}, 0));
+        if (writer == nullptr)
+        {
+            std::cerr << "Could not write " << outputFile.getFullPathName() << std::endl;
+            return 1;
+        }
+    }
+
+    DelayParameters params;
+    applyParameterOptions(args, params);
+
+    juce::dsp::ProcessSpec spec;
+    spec.sampleRate = sampleRate;
+    spec.maximumBlockSize = static_cast<juce::uint32>(blockSize);
+    spec.numChannels = static_cast<juce::uint32>(numChannels);
+
+    DelayEngine<float> engine;
+    engine.prepare(spec, params);
+
+    ChunkPipeline pipeline(numSlots, numChannels, chunkSize);
+    double busySeconds[ChunkPipeline::NumStages] = {};
+    bool readFailed = false;
+    bool writeFailed = false;
+
+    auto renderStart = std::chrono::steady_clock::now();
+
+    std::thread readThread([&]
+                           {
+        for (juce::int64 index = 0; index < numChunks; ++index)
+        {
+            auto *chunk = pipeline.acquire(ChunkPipeline::Read, index);
+            if (chunk == nullptr)
+                return;
+
+            auto start = std::chrono::steady_clock::now();
+            juce::int64 startSample = index * chunkSize;
+            chunk->numSamples = static_cast<int>(juce::jmin(static_cast<juce::int64>(chunkSize), lengthInSamples - startSample));
+
+            if (!reader.read(chunk->buffer, numChannels, startSample, chunk->numSamples, windowSamples))
+            {
+                readFailed = true;
+                pipeline.abort();
+                return;
+            }
+
+            busySeconds[ChunkPipeline::Read] += secondsSince(start);
+            pipeline.release(ChunkPipeline::Read);
+        } });
+
+    std::thread writeThread([&]
+                            {
+        for (juce::int64 index = 0; index < numChunks; ++index)
+        {
+            auto *chunk = pipeline.acquire(ChunkPipeline::Write, index);
+            if (chunk == nullptr)
+                return;
+
+            auto start = std::chrono::steady_clock::now();
+            if (writer != nullptr && !writer->writeFromAudioSampleBuffer(chunk->buffer, 0, chunk->numSamples))
+            {
+                writeFailed = true;
+                pipeline.abort();
+                return;
+            }
+
+            busySeconds[ChunkPipeline::Write] += secondsSince(start);
+            pipeline.release(ChunkPipeline::Write);
+        } });
+
+    // The DSP stage runs here, in host-sized blocks within each chunk
+    for (juce::int64 index = 0; index < numChunks; ++index)
+    {
+        auto *chunk = pipeline.acquire(ChunkPipeline::Process, index);
+        if (chunk == nullptr)
+            break;
+
+        auto start = std::chrono::steady_clock::now();
+        for (int offset = 0; offset < chunk->numSamples; offset += blockSize)
+        {
+            int numSamples = juce::jmin(blockSize, chunk->numSamples - offset);
+            juce::AudioBuffer<float> block(chunk->buffer.getArrayOfWritePointers(), numChannels, offset, numSamples);
+            engine.process(block, numChannels, params);
+        }
+
+        busySeconds[ChunkPipeline::Process] += secondsSince(start);
+        pipeline.release(ChunkPipeline::Process);
+    }
+
+    readThread.join();
+    writeThread.join();
+    writer.reset(); // flushes the file before the time is taken
+
+    double wallSeconds = secondsSince(renderStart);
+
+    if (readFailed || writeFailed)
+    {
+        std::cerr << (readFailed ? "Reading " + inputFile.getFullPathName() : juce::String("Writing the output")) << " failed" << std::endl;
+        return 1;
+    }
+
+    double audioSeconds = static_cast<double>(lengthInSamples) / sampleRate;
+    const char *stageNames[ChunkPipeline::NumStages] = {reader.isMapped() ? "Read (mapped)" : "Read (streamed)", "DSP", "Write"};
+
+    int bottleneck = 0;
+    for (int stage = 1; stage < ChunkPipeline::NumStages; ++stage)
+        if (busySeconds[stage] > busySeconds[bottleneck])
+            bottleneck = stage;
+
+    std::cout << "Rendered " << lengthInSamples << " samples (" << juce::String(audioSeconds, 1) << " s) at " << sampleRate << " Hz in "
+              << numChunks << " chunks of " << chunkSize << ", block size " << blockSize << std::endl;
+    std::cout << "Buffers: " << numSlots << " chunks, " << juce::String(pipeline.getBufferBytes() / 1024.0, 0) << " KiB";
+    if (reader.isMapped())
+        std::cout << ", mapped window " << juce::String(static_cast<double>(windowSamples * reader.get()->numChannels * reader.get()->bitsPerSample / 8) / 1048576.0, 1) << " MiB";
+    std::cout << std::endl
+              << std::endl
+              << "Stage                Busy s    Wait s   Share of wall" << std::endl;
+
+    for (int stage = 0; stage < ChunkPipeline::NumStages; ++stage)
+        std::cout << juce::String(stageNames[stage]).paddedRight(' ', 16)
+                  << juce::String(busySeconds[stage], 3).paddedLeft(' ', 10)
+                  << juce::String(pipeline.waitSeconds[stage], 3).paddedLeft(' ', 10)
+                  << (juce::String(100.0 * busySeconds[stage] / wallSeconds, 1) + "%").paddedLeft(' ', 16) << std::endl;
+
+    std::cout << std::endl
+              << "Wall " << juce::String(wallSeconds, 3) << " s, " << juce::String(audioSeconds / wallSeconds, 1) << "x real time; bottleneck: "
+              << (bottleneck == ChunkPipeline::Process ? "DSP" : "disk (" + juce::String(stageNames[bottleneck]) + ")") << std::endl;
+    return 0;
+}